@@ -0,0 +1,43 @@
+﻿#include "alloc_counter.hpp"
+
+#if ALLOC_COUNTER_ENABLED
+#include <cstdlib>
+#include <new>
+
+// Kiểu tầm thường nên thread_local không cần khởi tạo động, an toàn khi gọi từ operator new
+static thread_local uint64_t allocationCount = 0;
+
+uint64_t threadAllocationCount() {
+    return allocationCount;
+}
+
+void* operator new(size_t size) {
+    ++allocationCount;
+    if (void* memory = std::malloc(size ? size : 1)) return memory;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    ++allocationCount;
+    return std::malloc(size ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept {
+    return operator new(size, tag);
+}
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, size_t) noexcept { std::free(memory); }
+void operator delete(void* memory, const std::nothrow_t&) noexcept { std::free(memory); }
+void operator delete[](void* memory, const std::nothrow_t&) noexcept { std::free(memory); }
+#else
+uint64_t threadAllocationCount() {
+    return 0;
+}
+#endif
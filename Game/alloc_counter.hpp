@@ -0,0 +1,29 @@
+﻿#ifndef ALLOC_COUNTER_HPP
+#define ALLOC_COUNTER_HPP
+
+#include <cstdint>
+
+// Đếm số lần gọi operator new trên từng thread, để kiểm tra game loop không cấp phát heap.
+// Mặc định chỉ bật ở bản Debug; khi tắt, các hàm luôn trả về 0.
+#ifndef ALLOC_COUNTER_ENABLED
+#ifdef NDEBUG
+#define ALLOC_COUNTER_ENABLED 0
+#else
+#define ALLOC_COUNTER_ENABLED 1
+#endif
+#endif
+
+// Số lần cấp phát của thread gọi hàm, tính từ lúc thread bắt đầu
+uint64_t threadAllocationCount();
+
+// Đo số lần cấp phát trong một đoạn code trên thread hiện tại
+class AllocationScope {
+public:
+    AllocationScope() : start(threadAllocationCount()) {}
+    uint64_t count() const { return threadAllocationCount() - start; }
+
+private:
+    uint64_t start;
+};
+
+#endif // ALLOC_COUNTER_HPP
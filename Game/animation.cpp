@@ -1,73 +1,117 @@
 ﻿#include "animation.hpp"
-#include <GLFW/glfw3.h>
+#include <algorithm>
 
-bool AnimationController::isPlaying(const std::string& name) const {
-    return currentAnimation == name;
+AnimationLibrary::AnimationLibrary(TextureManager& tm)
+    : textureManager(tm), frames(1), bakedGeneration(tm.getGeneration()) {
 }
 
-AnimationController::AnimationController(TextureManager& tm)
-    : textureManager(tm), animationStartTime(0.0f), currentFrameIndex(0) {
+AnimationId AnimationLibrary::addAnimation(const std::string& name, const std::string& textureKey,
+    float frameDuration, bool loop, int frameCount, int startFrame, int sheetFrames) {
+    AnimationId existing = findAnimation(name);
+    if (existing != NO_ANIMATION) return existing;
+
+    Animation animation;
+    animation.name = name;
+    animation.texture = textureManager.getTextureId(textureKey);
+    animation.frameDuration = frameDuration;
+    animation.loop = loop;
+    animation.frameCount = std::max(frameCount, 1);
+    animation.sheetFrames = sheetFrames > 0 ? sheetFrames : animation.frameCount;
+    animation.startFrame = startFrame;
+    animation.firstFrame = static_cast<uint32_t>(frames.size());
+    frames.resize(frames.size() + animation.frameCount);
+
+    Clip clip;
+    clip.firstFrame = animation.firstFrame;
+    clip.frameCount = static_cast<uint32_t>(animation.frameCount);
+    clip.loopMask = loop ? 0xFFFFFFFFu : 0u;
+    clip.framesPerSecond = 1.0f / frameDuration;
+
+    animations.push_back(animation);
+    clips.push_back(clip);
+    bake(animation);
+    return static_cast<AnimationId>(animations.size() - 1);
 }
 
-void AnimationController::addAnimation(const std::string& name, const std::vector<std::string>& textureKeys,
-    float frameDuration, bool loop, int frameCount, bool isSpriteSheet, int startFrame) {
-    animations.emplace(name, Animation(textureKeys, frameDuration, loop, frameCount, isSpriteSheet, startFrame));
+AnimationId AnimationLibrary::findAnimation(const std::string& name) const {
+    for (size_t i = 0; i < animations.size(); ++i) {
+        if (animations[i].name == name) return static_cast<AnimationId>(i);
+    }
+    return NO_ANIMATION;
 }
 
-void AnimationController::playAnimation(const std::string& name, float currentTime) {
-    if (animations.find(name) != animations.end() && name != currentAnimation) {
-        currentAnimation = name;
-        animationStartTime = currentTime;
-        currentFrameIndex = 0;
+void AnimationLibrary::refresh() {
+    if (bakedGeneration == textureManager.getGeneration()) return;
+    bakedGeneration = textureManager.getGeneration();
+    for (const Animation& animation : animations) {
+        bake(animation);
     }
 }
 
-FrameResult AnimationController::getCurrentFrame() const {
-    if (currentAnimation.empty() || animations.find(currentAnimation) == animations.end()) {
-        return { 0, ImVec2(0, 0), ImVec2(1, 1) };
+void AnimationLibrary::bake(const Animation& animation) {
+    // Ảnh có thể nằm trong atlas nên UV của frame được tính trong vùng của nó
+    const TextureRegion& region = textureManager.getRegion(animation.texture);
+    float frameU = (region.u1 - region.u0) / animation.sheetFrames;
+    float frameWidth = static_cast<float>(region.width) / animation.sheetFrames;
+    for (int i = 0; i < animation.frameCount; ++i) {
+        AnimationFrame& frame = frames[animation.firstFrame + i];
+        frame.textureID = region.textureID;
+        frame.u0 = region.u0 + frameU * (animation.startFrame + i);
+        frame.u1 = frame.u0 + frameU;
+        frame.v0 = region.v0;
+        frame.v1 = region.v1;
+        frame.width = frameWidth;
+        frame.height = static_cast<float>(region.height);
     }
+}
 
-    const Animation& anim = animations.at(currentAnimation);
-    GLuint texID = textureManager.getTexture(anim.textureKeys[0]);
-
-    if (!anim.isSpriteSheet || anim.frameCount <= 1) {
-        return { texID, ImVec2(0, 0), ImVec2(1, 1) };
+uint32_t AnimationLibrary::frameIndex(AnimationId id, float elapsed) const {
+    if (id < 0 || id >= static_cast<AnimationId>(clips.size())) return 0;
+    const Clip& clip = clips[id];
+    uint32_t frame = static_cast<uint32_t>(std::max(elapsed, 0.0f) * clip.framesPerSecond);
+    if (clip.loopMask) {
+        frame %= clip.frameCount;
     }
-
-    float frameWidth = 1.0f / anim.frameCount;
-    size_t actualFrame = anim.startFrame + currentFrameIndex;
-
-    float u0 = frameWidth * actualFrame;
-    float u1 = u0 + frameWidth;
-
-    return { texID, ImVec2(u0, 0), ImVec2(u1, 1) };
+    else {
+        frame = std::min(frame, clip.frameCount - 1);
+    }
+    return clip.firstFrame + frame;
 }
 
-void AnimationController::update(float currentTime) {
-    if (currentAnimation.empty() || animations.find(currentAnimation) == animations.end()) return;
+void AnimationLibrary::sampleMany(const AnimationId* ids, const float* elapsed, size_t count, uint32_t* outFrameIndices) const {
+    const Clip* clipData = clips.data();
+    for (size_t i = 0; i < count; ++i) {
+        const Clip& clip = clipData[ids[i]];
+        uint32_t frame = static_cast<uint32_t>(std::max(elapsed[i], 0.0f) * clip.framesPerSecond);
+        uint32_t looped = frame % clip.frameCount;
+        uint32_t clamped = std::min(frame, clip.frameCount - 1);
+        outFrameIndices[i] = clip.firstFrame + ((looped & clip.loopMask) | (clamped & ~clip.loopMask));
+    }
+}
 
-    const Animation& anim = animations.at(currentAnimation);
-    float elapsed = currentTime - animationStartTime;
+bool AnimationLibrary::hasFinished(AnimationId id, float elapsed) const {
+    if (id < 0 || id >= static_cast<AnimationId>(clips.size())) return true;
+    const Clip& clip = clips[id];
+    if (clip.loopMask) return false;
+    return static_cast<uint32_t>(std::max(elapsed, 0.0f) * clip.framesPerSecond) >= clip.frameCount;
+}
 
-    size_t frameCount = anim.isSpriteSheet ? anim.frameCount : anim.textureKeys.size();
-    size_t newIndex = static_cast<size_t>(elapsed / anim.frameDuration);
+AnimationController::AnimationController(const AnimationLibrary& lib)
+    : library(&lib), currentAnimation(NO_ANIMATION), animationStartTime(0.0f) {
+}
 
-    if (anim.loop) {
-        currentFrameIndex = newIndex % frameCount;
-    }
-    else {
-        currentFrameIndex = std::min(newIndex, frameCount - 1);
+void AnimationController::playAnimation(AnimationId id, float currentTime) {
+    if (id != NO_ANIMATION && id != currentAnimation) {
+        currentAnimation = id;
+        animationStartTime = currentTime;
     }
 }
 
-bool AnimationController::hasFinished(const std::string& name, float currentTime) const {
-    if (animations.find(name) == animations.end()) return true;
-    const Animation& anim = animations.at(name);
-    if (anim.loop) return false;
-
-    float elapsed = currentTime - animationStartTime;
-    size_t frameCount = anim.isSpriteSheet ? anim.frameCount : anim.textureKeys.size();
-    size_t maxFrameIndex = frameCount - 1;
+bool AnimationController::isPlaying(AnimationId id) const {
+    return currentAnimation == id;
+}
 
-    return static_cast<size_t>(elapsed / anim.frameDuration) > maxFrameIndex;
+bool AnimationController::hasFinished(AnimationId id, float currentTime) const {
+    if (id != currentAnimation) return true;
+    return library->hasFinished(id, currentTime - animationStartTime);
 }
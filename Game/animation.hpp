@@ -1,51 +1,94 @@
 ﻿#ifndef ANIMATION_HPP
 #define ANIMATION_HPP
 
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 #include <string>
-#include <map>
 #include "texture_manager.hpp"
-#include "imgui.h"
 
-struct FrameResult {
-    GLuint textureID;
-    ImVec2 uv0;
-    ImVec2 uv1;
+// Một frame đã tính sẵn: UV trong texture (atlas) và kích thước theo pixel ảnh gốc
+struct AnimationFrame {
+    GLuint textureID = 0;
+    float u0 = 0.0f, v0 = 0.0f, u1 = 1.0f, v1 = 1.0f;
+    float width = 0.0f, height = 0.0f;
 };
 
+// Handle của animation trong AnimationLibrary, cấp khi addAnimation
+typedef int AnimationId;
+const AnimationId NO_ANIMATION = -1;
+
 struct Animation {
-    std::vector<std::string> textureKeys;
+    std::string name; // Chỉ dùng để debug
+    TextureId texture;
     float frameDuration;
     bool loop;
-    int frameCount = 1;
-    bool isSpriteSheet = false;
-    int startFrame = 0;
-
-    Animation(const std::vector<std::string>& keys, float duration, bool loop = true,
-        int count = 1, bool sheet = false, int start = 0)
-        : textureKeys(keys), frameDuration(duration), loop(loop),
-        frameCount(count), isSpriteSheet(sheet), startFrame(start) {
-    }
+    int frameCount;  // Số frame được phát
+    int sheetFrames; // Số frame xếp ngang trong sprite sheet
+    int startFrame;
+    uint32_t firstFrame; // Vị trí frame đầu tiên trong bảng frame chung
 };
 
-class AnimationController {
+// Danh sách animation dùng chung cho mọi nhân vật. Mỗi animation có một bảng frame
+// được tính một lần từ kích thước thật của texture, nên lấy frame chỉ là tra bảng
+// theo (animation, thời gian đã phát) và không phụ thuộc trạng thái nào khác.
+class AnimationLibrary {
 public:
-    AnimationController(TextureManager& textureManager);
-    void addAnimation(const std::string& name, const std::vector<std::string>& textureKeys,
-        float frameDuration, bool loop = true,
-        int frameCount = 1, bool isSpriteSheet = false, int startFrame = 0);
-    void playAnimation(const std::string& name, float currentTime);
-    FrameResult getCurrentFrame() const;
-    void update(float currentTime);
-    bool isPlaying(const std::string& name) const; // Add this declaration
-    bool hasFinished(const std::string& name, float currentTime) const;
+    explicit AnimationLibrary(TextureManager& textureManager);
+
+    // Đăng ký animation từ sprite sheet gồm sheetFrames frame xếp ngang (0 = frameCount)
+    AnimationId addAnimation(const std::string& name, const std::string& textureKey,
+        float frameDuration, bool loop = true, int frameCount = 1, int startFrame = 0, int sheetFrames = 0);
+    // Tìm handle theo tên, NO_ANIMATION nếu không có
+    AnimationId findAnimation(const std::string& name) const;
+    // Tính lại bảng frame nếu có texture vừa tải xong. Gọi trên thread OpenGL, gần như
+    // không tốn gì khi không có thay đổi
+    void refresh();
+
+    // Vị trí trong bảng frame của animation sau elapsed giây (0 = frame rỗng)
+    uint32_t frameIndex(AnimationId id, float elapsed) const;
+    const AnimationFrame& sample(AnimationId id, float elapsed) const { return frames[frameIndex(id, elapsed)]; }
+    // Lấy frame cho nhiều thực thể một lúc (mọi id phải hợp lệ); vòng lặp không rẽ nhánh
+    // để compiler vector hóa
+    void sampleMany(const AnimationId* ids, const float* elapsed, size_t count, uint32_t* outFrameIndices) const;
+    const AnimationFrame& frame(uint32_t index) const { return frames[index]; }
+    // Animation không lặp đã phát hết frame cuối
+    bool hasFinished(AnimationId id, float elapsed) const;
 
 private:
+    // Thông số của từng animation xếp liền nhau, đánh số theo AnimationId
+    struct Clip {
+        uint32_t firstFrame;
+        uint32_t frameCount;
+        uint32_t loopMask; // 0xFFFFFFFF nếu lặp
+        float framesPerSecond;
+    };
+
+    void bake(const Animation& animation);
+
     TextureManager& textureManager;
-    std::map<std::string, Animation> animations;
-    std::string currentAnimation;
+    std::vector<Animation> animations;
+    std::vector<Clip> clips;
+    std::vector<AnimationFrame> frames; // frames[0] là frame rỗng
+    uint32_t bakedGeneration;
+};
+
+// Trạng thái phát animation của một nhân vật
+class AnimationController {
+public:
+    explicit AnimationController(const AnimationLibrary& library);
+    // Bắt đầu phát từ currentTime nếu đang phát animation khác
+    void playAnimation(AnimationId id, float currentTime);
+    // Animation đang phát và thời gian đã phát, để lấy frame của nhiều nhân vật bằng sampleMany
+    AnimationId getCurrentAnimation() const { return currentAnimation; }
+    float getElapsed(float currentTime) const { return currentTime - animationStartTime; }
+    bool isPlaying(AnimationId id) const;
+    bool hasFinished(AnimationId id, float currentTime) const;
+
+private:
+    const AnimationLibrary* library;
+    AnimationId currentAnimation;
     float animationStartTime;
-    size_t currentFrameIndex;
 };
 
 #endif // ANIMATION_HPP
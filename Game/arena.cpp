@@ -0,0 +1,19 @@
+﻿#include "arena.hpp"
+#include <cstdlib>
+#include <new>
+
+Arena::Arena(size_t capacity)
+    : memory(static_cast<unsigned char*>(std::malloc(capacity))), size(capacity), used(0) {
+    if (!memory) throw std::bad_alloc();
+}
+
+Arena::~Arena() {
+    std::free(memory);
+}
+
+void* Arena::allocate(size_t bytes, size_t alignment) {
+    size_t offset = (used + alignment - 1) & ~(alignment - 1);
+    if (offset + bytes > size) throw std::bad_alloc();
+    used = offset + bytes;
+    return memory + offset;
+}
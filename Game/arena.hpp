@@ -0,0 +1,62 @@
+﻿#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include <cstddef>
+#include <type_traits>
+
+// Bộ cấp phát tuyến tính cho dữ liệu tạm chỉ sống trong một frame: một khối nhớ xin một lần,
+// cấp phát bằng cách tăng con trỏ và giải phóng tất cả cùng lúc bằng reset() (O(1)).
+// Không gọi destructor nên allocateArray chỉ nhận kiểu hủy tầm thường.
+// Dùng cho bộ nhớ tạm của một frame (main.cpp).
+class Arena {
+public:
+    explicit Arena(size_t capacity);
+    ~Arena();
+
+    // Ném std::bad_alloc nếu hết chỗ, giống new
+    void* allocate(size_t size, size_t alignment);
+
+    template <typename T>
+    T* allocateArray(size_t count) {
+        static_assert(std::is_trivially_destructible<T>::value, "arena memory is released without destructors");
+        return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    void reset() { used = 0; }
+    size_t bytesUsed() const { return used; }
+    size_t capacity() const { return size; }
+
+private:
+    unsigned char* memory;
+    size_t size;
+    size_t used;
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+};
+
+// Allocator cho container STL tạm thời (std::vector<T, ArenaAllocator<T>>): cấp phát từ Arena,
+// deallocate không làm gì, bộ nhớ được lấy lại khi Arena reset. Container phải bị hủy trước reset().
+template <typename T>
+class ArenaAllocator {
+public:
+    typedef T value_type;
+
+    explicit ArenaAllocator(Arena& arena) : arena(&arena) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+    T* allocate(size_t count) { return static_cast<T*>(arena->allocate(sizeof(T) * count, alignof(T))); }
+    void deallocate(T*, size_t) {}
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const { return arena == other.arena; }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const { return arena != other.arena; }
+
+private:
+    template <typename U> friend class ArenaAllocator;
+    Arena* arena;
+};
+
+#endif // ARENA_HPP
@@ -0,0 +1,32 @@
+﻿#ifndef ASSET_MANIFEST_HPP
+#define ASSET_MANIFEST_HPP
+
+// Danh sách ảnh của game, dùng chung cho game (khi tải trực tiếp) và asset_packer
+struct AssetEntry {
+    const char* key;
+    const char* path;
+    const char* group; // Tướng dùng ảnh này ("dausi", "xathu") để tải riêng khi chọn tướng, nullptr = ảnh chung
+};
+
+// Ảnh nền, mỗi ảnh một texture riêng
+const AssetEntry BACKGROUND_ASSETS[] = {
+    { "menu_background", "../x64/Debug/bg.jpg", nullptr },
+    { "game_background", "../x64/Debug/fbg.jpg", nullptr },
+};
+
+// Sprite sheet của các tướng và mũi tên dùng chung một atlas để cả frame chỉ bind một texture
+const AssetEntry SPRITE_ASSETS[] = {
+    { "dausi_idle", "../x64/Debug/DauSi/Sprites/Idle.png", "dausi" },
+    { "dausi_run", "../x64/Debug/DauSi/Sprites/Run.png", "dausi" },
+    { "dausi_attack", "../x64/Debug/DauSi/Sprites/Attack1.png", "dausi" },
+    { "xathu_idle", "../x64/Debug/XaThu/Idle.png", "xathu" },
+    { "xathu_running", "../x64/Debug/XaThu/Running.png", "xathu" },
+    { "arrow", "../x64/Debug/arrow.PNG", "xathu" },
+};
+
+const int SPRITE_ATLAS_SIZE = 2048;
+
+// File tạo bởi asset_packer, nếu có thì game tải thay cho các ảnh gốc
+const char* const ASSET_PACK_PATH = "../x64/Debug/assets.pak";
+
+#endif // ASSET_MANIFEST_HPP
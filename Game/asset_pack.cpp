@@ -0,0 +1,134 @@
+﻿#include "asset_pack.hpp"
+#include "logger.hpp"
+#include <cstring>
+#include <fstream>
+
+AssetPack::AssetPack() : header(nullptr), textures(nullptr), regions(nullptr) {
+}
+
+bool AssetPack::open(const std::string& path) {
+    close();
+    if (!file.open(path)) {
+        return false;
+    }
+
+    const size_t fileSize = file.size();
+    if (fileSize < sizeof(AssetPackHeader)) {
+        LOG_ERROR("Asset pack too small: {}", path);
+        close();
+        return false;
+    }
+    const AssetPackHeader* candidate = reinterpret_cast<const AssetPackHeader*>(file.data());
+    if (std::memcmp(candidate->magic, ASSET_PACK_MAGIC, sizeof(ASSET_PACK_MAGIC)) != 0 ||
+        candidate->version != ASSET_PACK_VERSION) {
+        LOG_ERROR("Asset pack has wrong magic or version: {}", path);
+        close();
+        return false;
+    }
+
+    const uint64_t indexEnd = sizeof(AssetPackHeader)
+        + static_cast<uint64_t>(candidate->textureCount) * sizeof(AssetPackTexture)
+        + static_cast<uint64_t>(candidate->regionCount) * sizeof(AssetPackRegion);
+    if (indexEnd > fileSize) {
+        LOG_ERROR("Asset pack index is truncated: {}", path);
+        close();
+        return false;
+    }
+    const AssetPackTexture* textureTable = reinterpret_cast<const AssetPackTexture*>(file.data() + sizeof(AssetPackHeader));
+    const AssetPackRegion* regionTable = reinterpret_cast<const AssetPackRegion*>(textureTable + candidate->textureCount);
+
+    for (uint32_t i = 0; i < candidate->textureCount; ++i) {
+        const AssetPackTexture& entry = textureTable[i];
+        if (entry.size != static_cast<uint64_t>(entry.width) * entry.height * 4 ||
+            entry.offset < indexEnd || entry.offset > fileSize || entry.size > fileSize - entry.offset) {
+            LOG_ERROR("Asset pack texture {} is out of bounds: {}", i, path);
+            close();
+            return false;
+        }
+    }
+    for (uint32_t i = 0; i < candidate->regionCount; ++i) {
+        const AssetPackRegion& entry = regionTable[i];
+        if (entry.texture >= candidate->textureCount ||
+            std::memchr(entry.key, '\0', ASSET_PACK_KEY_SIZE) == nullptr) {
+            LOG_ERROR("Asset pack region {} is invalid: {}", i, path);
+            close();
+            return false;
+        }
+    }
+
+    header = candidate;
+    textures = textureTable;
+    regions = regionTable;
+    return true;
+}
+
+void AssetPack::close() {
+    file.close();
+    header = nullptr;
+    textures = nullptr;
+    regions = nullptr;
+}
+
+bool writeAssetPack(const std::string& path, const std::vector<AtlasPage>& pages) {
+    AssetPackHeader header;
+    std::memcpy(header.magic, ASSET_PACK_MAGIC, sizeof(header.magic));
+    header.version = ASSET_PACK_VERSION;
+    header.textureCount = static_cast<uint32_t>(pages.size());
+    header.regionCount = 0;
+
+    std::vector<AssetPackRegion> regionTable;
+    for (size_t i = 0; i < pages.size(); ++i) {
+        for (const AtlasRegion& region : pages[i].regions) {
+            if (region.key.size() >= ASSET_PACK_KEY_SIZE) {
+                LOG_ERROR("Asset key too long for pack: {}", region.key);
+                return false;
+            }
+            AssetPackRegion entry = {};
+            std::memcpy(entry.key, region.key.c_str(), region.key.size());
+            entry.texture = static_cast<uint32_t>(i);
+            entry.u0 = region.u0;
+            entry.v0 = region.v0;
+            entry.u1 = region.u1;
+            entry.v1 = region.v1;
+            entry.width = static_cast<uint32_t>(region.width);
+            entry.height = static_cast<uint32_t>(region.height);
+            regionTable.push_back(entry);
+        }
+    }
+    header.regionCount = static_cast<uint32_t>(regionTable.size());
+
+    // Căn khối điểm ảnh theo trang bộ nhớ để con trỏ từ file map luôn thẳng hàng
+    auto align = [](uint64_t offset) {
+        return (offset + ASSET_PACK_ALIGNMENT - 1) / ASSET_PACK_ALIGNMENT * ASSET_PACK_ALIGNMENT;
+    };
+    std::vector<AssetPackTexture> textureTable;
+    uint64_t offset = sizeof(AssetPackHeader)
+        + pages.size() * sizeof(AssetPackTexture)
+        + regionTable.size() * sizeof(AssetPackRegion);
+    for (const AtlasPage& page : pages) {
+        AssetPackTexture entry;
+        entry.width = static_cast<uint32_t>(page.width);
+        entry.height = static_cast<uint32_t>(page.height);
+        entry.offset = align(offset);
+        entry.size = page.pixels.size();
+        textureTable.push_back(entry);
+        offset = entry.offset + entry.size;
+    }
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        LOG_ERROR("Failed to open asset pack for writing: {}", path);
+        return false;
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(textureTable.data()), textureTable.size() * sizeof(AssetPackTexture));
+    out.write(reinterpret_cast<const char*>(regionTable.data()), regionTable.size() * sizeof(AssetPackRegion));
+    uint64_t written = sizeof(header) + textureTable.size() * sizeof(AssetPackTexture) + regionTable.size() * sizeof(AssetPackRegion);
+    const char padding[ASSET_PACK_ALIGNMENT] = {};
+    for (size_t i = 0; i < pages.size(); ++i) {
+        out.write(padding, static_cast<std::streamsize>(textureTable[i].offset - written));
+        out.write(reinterpret_cast<const char*>(pages[i].pixels.data()), static_cast<std::streamsize>(pages[i].pixels.size()));
+        written = textureTable[i].offset + textureTable[i].size;
+    }
+    return static_cast<bool>(out);
+}
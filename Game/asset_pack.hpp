@@ -0,0 +1,67 @@
+﻿#ifndef ASSET_PACK_HPP
+#define ASSET_PACK_HPP
+
+#include "mapped_file.hpp"
+#include "texture_atlas.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Định dạng file asset pack (little-endian):
+//   AssetPackHeader
+//   AssetPackTexture[textureCount]
+//   AssetPackRegion[regionCount]
+//   dữ liệu RGBA8 của từng texture, mỗi khối bắt đầu ở offset chia hết cho ASSET_PACK_ALIGNMENT
+// Ảnh đã được lật dọc và xếp atlas sẵn nên khi tải chỉ cần upload thẳng lên GPU.
+const char ASSET_PACK_MAGIC[4] = { 'G', 'P', 'A', 'K' };
+const uint32_t ASSET_PACK_VERSION = 1;
+const uint32_t ASSET_PACK_ALIGNMENT = 4096;
+const size_t ASSET_PACK_KEY_SIZE = 48;
+
+struct AssetPackHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t textureCount;
+    uint32_t regionCount;
+};
+
+struct AssetPackTexture {
+    uint32_t width, height;
+    uint64_t offset; // Tính từ đầu file
+    uint64_t size;
+};
+
+struct AssetPackRegion {
+    char key[ASSET_PACK_KEY_SIZE]; // Kết thúc bằng '\0'
+    uint32_t texture;              // Chỉ số trong bảng texture
+    float u0, v0, u1, v1;
+    uint32_t width, height;
+};
+
+// Đọc asset pack qua MappedFile, không chép dữ liệu điểm ảnh
+class AssetPack {
+public:
+    AssetPack();
+
+    // Map file và kiểm tra header, bảng chỉ mục. Trả về false nếu file không hợp lệ
+    bool open(const std::string& path);
+    void close();
+
+    uint32_t textureCount() const { return header ? header->textureCount : 0; }
+    uint32_t regionCount() const { return header ? header->regionCount : 0; }
+    const AssetPackTexture& texture(uint32_t index) const { return textures[index]; }
+    const AssetPackRegion& region(uint32_t index) const { return regions[index]; }
+    // Con trỏ vào vùng nhớ đã map, hợp lệ cho tới khi close()
+    const unsigned char* pixels(uint32_t index) const { return file.data() + textures[index].offset; }
+
+private:
+    MappedFile file;
+    const AssetPackHeader* header;
+    const AssetPackTexture* textures;
+    const AssetPackRegion* regions;
+};
+
+// Ghi các trang atlas thành một file asset pack
+bool writeAssetPack(const std::string& path, const std::vector<AtlasPage>& pages);
+
+#endif // ASSET_PACK_HPP
@@ -0,0 +1,95 @@
+﻿#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+#include "asset_manifest.hpp"
+#include "asset_pack.hpp"
+#include "texture_atlas.hpp"
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Công cụ chạy offline: giải mã toàn bộ ảnh trong asset_manifest.hpp, xếp atlas
+// và ghi thành một file asset pack để game chỉ cần map file rồi upload.
+// Ví dụ (chạy trong thư mục Game): asset_packer ../x64/Debug/assets.pak
+
+struct LoadedImage {
+    std::string key;
+    int width = 0, height = 0;
+    unsigned char* pixels = nullptr;
+};
+
+static bool loadImage(const AssetEntry& entry, LoadedImage& out) {
+    int width, height, channels;
+    unsigned char* pixels = stbi_load(entry.path, &width, &height, &channels, 4);
+    if (!pixels) {
+        std::fprintf(stderr, "Skipping %s (%s): %s\n", entry.key, entry.path, stbi_failure_reason());
+        return false;
+    }
+    out.key = entry.key;
+    out.width = width;
+    out.height = height;
+    out.pixels = pixels;
+    return true;
+}
+
+int main(int argc, char** argv) {
+    std::string outputPath = ASSET_PACK_PATH;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--help") == 0 || std::strcmp(argv[i], "-h") == 0) {
+            std::fprintf(stderr, "Usage: asset_packer [output.pak]   (mac dinh %s)\n", ASSET_PACK_PATH);
+            return 0;
+        }
+        outputPath = argv[i];
+    }
+
+    // Lật dọc giống TextureManager để dữ liệu trong pack upload được ngay
+    stbi_set_flip_vertically_on_load(true);
+
+    std::vector<AtlasPage> pages;
+    for (const AssetEntry& entry : BACKGROUND_ASSETS) {
+        LoadedImage image;
+        if (!loadImage(entry, image)) continue;
+        AtlasPage page;
+        page.width = image.width;
+        page.height = image.height;
+        page.pixels.assign(image.pixels, image.pixels + static_cast<size_t>(image.width) * image.height * 4);
+        page.regions.push_back({ image.key, 0.0f, 0.0f, 1.0f, 1.0f, image.width, image.height });
+        pages.push_back(std::move(page));
+        stbi_image_free(image.pixels);
+    }
+
+    std::vector<LoadedImage> sprites;
+    std::vector<AtlasImage> atlasImages;
+    for (const AssetEntry& entry : SPRITE_ASSETS) {
+        LoadedImage image;
+        if (!loadImage(entry, image)) continue;
+        sprites.push_back(image);
+        atlasImages.push_back({ image.key, image.width, image.height, image.pixels });
+    }
+    for (AtlasPage& page : buildAtlasPages(atlasImages, SPRITE_ATLAS_SIZE)) {
+        pages.push_back(std::move(page));
+    }
+    for (LoadedImage& image : sprites) {
+        stbi_image_free(image.pixels);
+    }
+
+    if (!writeAssetPack(outputPath, pages)) {
+        return 1;
+    }
+
+    // Đọc lại để chắc chắn file hợp lệ
+    AssetPack pack;
+    if (!pack.open(outputPath)) {
+        std::fprintf(stderr, "Written pack failed validation: %s\n", outputPath.c_str());
+        return 1;
+    }
+    std::printf("Wrote %s: %u texture(s), %u region(s)\n", outputPath.c_str(), pack.textureCount(), pack.regionCount());
+    for (uint32_t i = 0; i < pack.regionCount(); ++i) {
+        const AssetPackRegion& region = pack.region(i);
+        const AssetPackTexture& texture = pack.texture(region.texture);
+        std::printf("  %-16s %4ux%-4u in texture %u (%ux%u)\n", region.key, region.width, region.height,
+            region.texture, texture.width, texture.height);
+    }
+    return 0;
+}
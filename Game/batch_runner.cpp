@@ -0,0 +1,276 @@
+﻿#include "match_simulation.hpp"
+#include "match_bot.hpp"
+#include "thread_pool.hpp"
+#include "logger.hpp"
+#include "profiler.hpp"
+#include "replay.hpp"
+#include "alloc_counter.hpp"
+#include "json.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Chạy hàng loạt trận đấu không giao diện để thống kê cân bằng tướng.
+// Ví dụ: batch_runner --matches 5000 --matchup all --p1-bot scripted --p2-bot scripted
+
+struct BatchOptions {
+    int matches = 1000;
+    unsigned threads = 0;
+    uint64_t seed = 1;
+    uint32_t maxTicks = 180 * TICK_RATE;
+    std::string matchup = "all";
+    BotPolicy p1Bot = BOT_SCRIPTED;
+    BotPolicy p2Bot = BOT_SCRIPTED;
+    std::string jsonPath;
+    std::string tracePath;
+    std::string recordDir;
+};
+
+// Tick đầu trận được phép cấp phát; sau đó step() phải chạy không đụng heap
+const uint32_t ALLOC_WARMUP_TICKS = TICK_RATE;
+
+struct MatchResult {
+    int winner = 0;
+    uint32_t ticks = 0;
+    float damage[2][DAMAGE_SOURCE_COUNT] = {};
+    uint64_t stepAllocations = 0; // Số lần cấp phát heap trong step() sau ALLOC_WARMUP_TICKS
+};
+
+struct Matchup {
+    CharacterType p1;
+    CharacterType p2;
+    const char* name;
+};
+
+static const Matchup ALL_MATCHUPS[] = {
+    { XA_THU, XA_THU, "xt-xt" },
+    { XA_THU, DAU_SI, "xt-ds" },
+    { DAU_SI, XA_THU, "ds-xt" },
+    { DAU_SI, DAU_SI, "ds-ds" },
+};
+
+static const char* DAMAGE_SOURCE_NAMES[DAMAGE_SOURCE_COUNT] = {
+    "melee", "combo", "arrow", "charged_arrow", "skill"
+};
+
+static const char* characterName(CharacterType type) {
+    return type == DAU_SI ? "DauSi" : "XaThu";
+}
+
+// Tách seed gốc thành seed độc lập cho từng trận
+static uint64_t splitMix64(uint64_t value) {
+    return MatchRng::splitMix64(value);
+}
+
+static bool parseBot(const char* text, BotPolicy& policy) {
+    if (std::strcmp(text, "scripted") == 0) policy = BOT_SCRIPTED;
+    else if (std::strcmp(text, "random") == 0) policy = BOT_RANDOM;
+    else if (std::strcmp(text, "idle") == 0) policy = BOT_IDLE;
+    else return false;
+    return true;
+}
+
+static void printUsage() {
+    std::fprintf(stderr,
+        "Usage: batch_runner [options]\n"
+        "  --matches N        so tran cho moi cap dau (mac dinh 1000)\n"
+        "  --threads N        so thread, 0 = tat ca nhan CPU (mac dinh 0)\n"
+        "  --seed N           seed goc (mac dinh 1)\n"
+        "  --max-ticks N      so tick toi da moi tran, het gio tinh hoa\n"
+        "  --matchup NAME     all | xt-xt | xt-ds | ds-xt | ds-ds\n"
+        "  --p1-bot NAME      scripted | random | idle\n"
+        "  --p2-bot NAME      scripted | random | idle\n"
+        "  --json PATH        ghi ket qua tong hop ra file JSON\n"
+        "  --trace PATH       ghi profile dang Chrome trace (chrome://tracing, Perfetto)\n"
+        "  --record DIR       ghi replay cua tung tran vao DIR/match_NNNNNN.lqr\n");
+}
+
+static bool parseOptions(int argc, char** argv, BatchOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (!value) return false;
+        if (std::strcmp(arg, "--matches") == 0) options.matches = std::atoi(value);
+        else if (std::strcmp(arg, "--threads") == 0) options.threads = static_cast<unsigned>(std::atoi(value));
+        else if (std::strcmp(arg, "--seed") == 0) options.seed = std::strtoull(value, nullptr, 10);
+        else if (std::strcmp(arg, "--max-ticks") == 0) options.maxTicks = static_cast<uint32_t>(std::atoi(value));
+        else if (std::strcmp(arg, "--matchup") == 0) options.matchup = value;
+        else if (std::strcmp(arg, "--p1-bot") == 0) { if (!parseBot(value, options.p1Bot)) return false; }
+        else if (std::strcmp(arg, "--p2-bot") == 0) { if (!parseBot(value, options.p2Bot)) return false; }
+        else if (std::strcmp(arg, "--json") == 0) options.jsonPath = value;
+        else if (std::strcmp(arg, "--trace") == 0) options.tracePath = value;
+        else if (std::strcmp(arg, "--record") == 0) options.recordDir = value;
+        else return false;
+        ++i;
+    }
+    return options.matches > 0;
+}
+
+static MatchResult runMatch(const Matchup& matchup, const BatchOptions& options, uint64_t matchSeed, size_t index) {
+    PROFILE_ZONE("runMatch");
+    MatchSimulation sim;
+    sim.start(matchup.p1, matchup.p2, static_cast<uint32_t>(matchSeed));
+    MatchBot bot1(options.p1Bot, 0, static_cast<uint32_t>(matchSeed >> 32));
+    MatchBot bot2(options.p2Bot, 1, static_cast<uint32_t>(splitMix64(matchSeed)));
+    bool recording = !options.recordDir.empty();
+    Replay replay;
+    if (recording) replay.begin(sim);
+
+    uint64_t stepAllocations = 0;
+    while (sim.isRunning() && sim.state.tick < options.maxTicks) {
+        MatchInput input;
+        input.buttons[0] = bot1.think(sim);
+        input.buttons[1] = bot2.think(sim);
+        if (recording) replay.record(input);
+        if (ALLOC_COUNTER_ENABLED && sim.state.tick >= ALLOC_WARMUP_TICKS) {
+            AllocationScope allocations;
+            sim.step(input);
+            stepAllocations += allocations.count();
+        }
+        else {
+            sim.step(input);
+        }
+    }
+
+    if (recording) {
+        replay.finish(sim);
+        char name[32];
+        std::snprintf(name, sizeof(name), "/match_%06zu.lqr", index);
+        if (!saveReplay(options.recordDir + name, replay)) {
+            LOG_ERROR("Could not write replay {}{}", options.recordDir, name);
+        }
+    }
+
+    MatchResult result;
+    result.winner = sim.winner();
+    result.ticks = sim.state.tick;
+    result.stepAllocations = stepAllocations;
+    for (int source = 0; source < DAMAGE_SOURCE_COUNT; ++source) {
+        result.damage[0][source] = sim.fighter(0).damageDealt[source];
+        result.damage[1][source] = sim.fighter(1).damageDealt[source];
+    }
+    return result;
+}
+
+int main(int argc, char** argv) {
+    BatchOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return 1;
+    }
+
+    std::vector<Matchup> matchups;
+    for (const Matchup& m : ALL_MATCHUPS) {
+        if (options.matchup == "all" || options.matchup == m.name) matchups.push_back(m);
+    }
+    if (matchups.empty()) {
+        printUsage();
+        return 1;
+    }
+
+    // Chỉ giữ cảnh báo và lỗi khi chạy hàng loạt, log gameplay chỉ làm chậm các thread
+    Logger::instance().setLevel(LOG_LEVEL_WARN);
+    Profiler::setThreadName("Main");
+    Profiler::instance().setEnabled(!options.tracePath.empty());
+    if (!options.recordDir.empty()) {
+        std::error_code error;
+        std::filesystem::create_directories(options.recordDir, error);
+    }
+
+    const int CHUNK_SIZE = 16;
+    size_t totalMatches = matchups.size() * static_cast<size_t>(options.matches);
+    std::vector<MatchResult> results(totalMatches);
+
+    auto startTime = std::chrono::steady_clock::now();
+    {
+        ThreadPool pool(options.threads);
+        std::fprintf(stderr, "Running %zu matches on %u threads\n", totalMatches, pool.size());
+        for (size_t first = 0; first < totalMatches; first += CHUNK_SIZE) {
+            size_t last = std::min(first + CHUNK_SIZE, totalMatches);
+            pool.submit([&, first, last] {
+                for (size_t i = first; i < last; ++i) {
+                    const Matchup& matchup = matchups[i / options.matches];
+                    results[i] = runMatch(matchup, options, splitMix64(options.seed + i), i);
+                }
+            });
+        }
+        pool.wait();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    nlohmann::json report;
+    uint64_t totalTicks = 0;
+    uint64_t stepAllocations = 0;
+    for (const MatchResult& r : results) stepAllocations += r.stepAllocations;
+    for (size_t m = 0; m < matchups.size(); ++m) {
+        int wins[3] = { 0, 0, 0 };
+        double ticks = 0.0;
+        double damage[2][DAMAGE_SOURCE_COUNT] = {};
+        for (int i = 0; i < options.matches; ++i) {
+            const MatchResult& r = results[m * options.matches + i];
+            wins[r.winner]++;
+            ticks += r.ticks;
+            for (int p = 0; p < 2; ++p)
+                for (int s = 0; s < DAMAGE_SOURCE_COUNT; ++s)
+                    damage[p][s] += r.damage[p][s];
+        }
+        totalTicks += static_cast<uint64_t>(ticks);
+
+        double n = options.matches;
+        std::printf("%s (P1) vs %s (P2): %d matches\n", characterName(matchups[m].p1), characterName(matchups[m].p2), options.matches);
+        std::printf("  P1 win %.1f%%  P2 win %.1f%%  draw %.1f%%\n", 100.0 * wins[1] / n, 100.0 * wins[2] / n, 100.0 * wins[0] / n);
+        std::printf("  avg length %.1f s (%.0f ticks)\n", ticks / n * TICK_DT, ticks / n);
+
+        nlohmann::json entry;
+        entry["p1"] = characterName(matchups[m].p1);
+        entry["p2"] = characterName(matchups[m].p2);
+        entry["matches"] = options.matches;
+        entry["p1_win_rate"] = wins[1] / n;
+        entry["p2_win_rate"] = wins[2] / n;
+        entry["draw_rate"] = wins[0] / n;
+        entry["avg_ticks"] = ticks / n;
+        for (int p = 0; p < 2; ++p) {
+            std::printf("  P%d avg damage/match:", p + 1);
+            for (int s = 0; s < DAMAGE_SOURCE_COUNT; ++s) {
+                std::printf(" %s %.1f", DAMAGE_SOURCE_NAMES[s], damage[p][s] / n);
+                entry[p == 0 ? "p1_damage" : "p2_damage"][DAMAGE_SOURCE_NAMES[s]] = damage[p][s] / n;
+            }
+            std::printf("\n");
+        }
+        report["matchups"][matchups[m].name] = entry;
+    }
+
+    std::printf("%zu matches, %llu ticks in %.2f s (%.0f ticks/s)\n", totalMatches,
+        static_cast<unsigned long long>(totalTicks), seconds, totalTicks / seconds);
+    if (ALLOC_COUNTER_ENABLED) {
+        std::printf("heap allocations in step() after %u warm-up ticks: %llu\n", ALLOC_WARMUP_TICKS,
+            static_cast<unsigned long long>(stepAllocations));
+    }
+    else {
+        std::printf("heap allocations in step(): not counted (ALLOC_COUNTER_ENABLED=0)\n");
+    }
+
+    if (!options.jsonPath.empty()) {
+        report["seed"] = options.seed;
+        report["seconds"] = seconds;
+        std::ofstream file(options.jsonPath);
+        file << report.dump(2) << "\n";
+    }
+    if (!options.tracePath.empty()) {
+        Profiler& profiler = Profiler::instance();
+        profiler.setEnabled(false);
+        if (!profiler.writeChromeTrace(options.tracePath)) {
+            std::fprintf(stderr, "Could not write trace to %s\n", options.tracePath.c_str());
+            return 1;
+        }
+        std::fprintf(stderr, "Wrote %zu profile zones to %s (%llu dropped)\n", profiler.eventCount(),
+            options.tracePath.c_str(), static_cast<unsigned long long>(profiler.droppedCount()));
+    }
+    // Mô phỏng cấp phát giữa trận là lỗi: trả về mã lỗi để CI bắt được
+    return stepAllocations == 0 ? 0 : 1;
+}
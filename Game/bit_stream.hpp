@@ -0,0 +1,71 @@
+﻿#ifndef BIT_STREAM_HPP
+#define BIT_STREAM_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// Ghi các giá trị độ dài bất kỳ (1..32 bit) liền nhau, bit thấp trước, vào một bộ đệm cố định
+class BitWriter {
+public:
+    BitWriter(uint8_t* out, size_t capacity) : out(out), capacity(capacity) {}
+
+    // value phải vừa bits bit
+    void write(uint32_t value, int bits) {
+        pending |= static_cast<uint64_t>(value) << pendingBits;
+        pendingBits += bits;
+        while (pendingBits >= 8) {
+            if (size < capacity) out[size] = static_cast<uint8_t>(pending);
+            ++size;
+            pending >>= 8;
+            pendingBits -= 8;
+        }
+    }
+
+    // Ghi nốt byte cuối chưa đầy; trả về số byte, 0 nếu không vừa bộ đệm
+    size_t finish() {
+        if (pendingBits > 0) write(0, 8 - pendingBits);
+        return size <= capacity ? size : 0;
+    }
+
+private:
+    uint8_t* out;
+    size_t capacity;
+    size_t size = 0;
+    uint64_t pending = 0;
+    int pendingBits = 0;
+};
+
+// Đọc lại những gì BitWriter đã ghi. Đọc quá cuối dữ liệu trả về 0 và bật failed()
+class BitReader {
+public:
+    BitReader(const uint8_t* data, size_t size) : data(data), size(size) {}
+
+    uint32_t read(int bits) {
+        while (pendingBits < bits) {
+            if (position >= size) {
+                failed = true;
+                return 0;
+            }
+            pending |= static_cast<uint64_t>(data[position++]) << pendingBits;
+            pendingBits += 8;
+        }
+        uint32_t value = static_cast<uint32_t>(pending & ((static_cast<uint64_t>(1) << bits) - 1));
+        pending >>= bits;
+        pendingBits -= bits;
+        return value;
+    }
+
+    // Đã đọc hết dữ liệu (chỉ còn bit đệm của byte cuối) và không đọc quá
+    bool finished() const { return !failed && position == size && pendingBits < 8; }
+    bool hasFailed() const { return failed; }
+
+private:
+    const uint8_t* data;
+    size_t size;
+    size_t position = 0;
+    uint64_t pending = 0;
+    int pendingBits = 0;
+    bool failed = false;
+};
+
+#endif // BIT_STREAM_HPP
@@ -0,0 +1,203 @@
+﻿#include "bot_client.hpp"
+#include "logger.hpp"
+#include "match_snapshot.hpp"
+#include "profiler.hpp"
+#include "server_protocol.hpp"
+#include <algorithm>
+
+const int BOT_INPUT_HISTORY = 64;      // Lũy thừa của 2, lớn hơn MAX_SERVER_INPUTS_PER_PACKET
+const double JOIN_RESEND_INTERVAL = 0.25;
+const int BOT_POLL_MS = 10;
+
+struct BotClientGroup::Client {
+    Client(uint32_t matchId, int player, CharacterType character, BotPolicy policy, uint32_t seed)
+        : matchId(matchId), player(player), character(character), bot(policy, player, seed) {
+    }
+
+    UdpSocket socket;
+    NetAddress server;
+    uint32_t matchId;
+    int player;
+    CharacterType character;
+    MatchBot bot;
+    bool welcomed = false;
+    bool playing = false;  // Đã nhận snapshot đầu tiên
+    bool done = false;
+    double lastJoinAt = -1.0;
+    uint8_t inputs[BOT_INPUT_HISTORY] = {};
+    uint32_t inputCount = 0;  // Đã quyết định nút cho các frame [0, inputCount)
+    uint32_t inputAcked = 0;  // Server đã nhận [0, inputAcked)
+    uint32_t lastTick = 0;    // Tick của snapshot mới nhất, báo lại cho server làm baseline
+    MatchSnapshot snapshot;
+    SnapshotHistory received;
+};
+
+static double nowSeconds() {
+    return Profiler::nowNanos() * 1e-9;
+}
+
+BotClientGroup::BotClientGroup() {
+}
+
+BotClientGroup::~BotClientGroup() {
+}
+
+bool BotClientGroup::start(const NetAddress& server, uint32_t firstMatchId, int matchCount, BotPolicy policy,
+    uint64_t seed, int inputLead) {
+    this->firstMatchId = firstMatchId;
+    this->inputLead = std::max(1, inputLead);
+    clients.clear();
+    matchResults.assign(matchCount, BotMatchResult());
+
+    for (int m = 0; m < matchCount; ++m) {
+        uint32_t matchId = firstMatchId + m;
+        matchResults[m].matchId = matchId;
+        // Cùng thứ tự với ALL_MATCHUPS của batch_runner: xt-xt, xt-ds, ds-xt, ds-ds
+        CharacterType types[2] = { (matchId / 2) % 2 ? DAU_SI : XA_THU, matchId % 2 ? DAU_SI : XA_THU };
+        for (int p = 0; p < 2; ++p) {
+            uint64_t botSeed = seed + matchId * 2 + p;
+            std::unique_ptr<Client> client(new Client(matchId, p, types[p], policy,
+                static_cast<uint32_t>(MatchRng::splitMix64(botSeed))));
+            client->server = server;
+            if (!client->socket.open(0) || !poller.add(client->socket, static_cast<uint32_t>(clients.size()))) {
+                LOG_ERROR("Could not open a UDP socket for bot client {}", clients.size());
+                return false;
+            }
+            clients.push_back(std::move(client));
+        }
+    }
+    remaining = static_cast<int>(clients.size());
+    return true;
+}
+
+bool BotClientGroup::run(double timeoutSeconds) {
+    std::vector<uint32_t> ready;
+    ready.reserve(clients.size());
+    uint8_t buffer[MAX_UDP_PACKET_SIZE];
+    double deadline = nowSeconds() + timeoutSeconds;
+
+    while (remaining > 0) {
+        double now = nowSeconds();
+        if (now >= deadline) return false;
+        for (const std::unique_ptr<Client>& client : clients) {
+            // Gói JOIN có thể mất; gửi lại đến khi server trả lời
+            if (!client->done && !client->welcomed && !client->playing && now - client->lastJoinAt >= JOIN_RESEND_INTERVAL) {
+                sendJoin(*client, now);
+            }
+        }
+
+        poller.wait(BOT_POLL_MS, ready);
+        now = nowSeconds();
+        for (uint32_t tag : ready) {
+            Client& client = *clients[tag];
+            NetAddress from;
+            size_t size;
+            while ((size = client.socket.receive(from, buffer, sizeof(buffer))) > 0) {
+                if (from != client.server) continue;
+                handlePacket(client, buffer, size, now);
+            }
+        }
+    }
+    return true;
+}
+
+void BotClientGroup::handlePacket(Client& client, const uint8_t* data, size_t size, double now) {
+    ServerPacket packet;
+    if (!readServerPacket(data, size, packet) || packet.matchId != client.matchId || client.done) return;
+    BotMatchResult& result = matchResults[client.matchId - firstMatchId];
+
+    switch (packet.type) {
+    case PACKET_REDIRECT:
+        client.server.port = packet.port;
+        sendJoin(client, now);
+        return;
+    case PACKET_WELCOME:
+        client.welcomed = true;
+        return;
+    case PACKET_REJECT:
+        LOG_WARN("Server rejected bot client for match {}", client.matchId);
+        result.rejected = true;
+        markDone(client);
+        return;
+    case PACKET_SNAPSHOT:
+        break;
+    default:
+        return;
+    }
+
+    // Baseline đã bị đẩy khỏi history thì bỏ gói; ack tiếp theo cho server biết mà gửi bản mới
+    if (!decodeSnapshot(packet.payload, packet.payloadSize, client.received, client.snapshot)) return;
+    client.received.store(client.snapshot);
+    ++result.snapshots;
+    result.snapshotBytes += size;
+
+    // Server tự điền nút cho các frame có input đến trễ, nên số đã nhận có thể vượt số đã gửi
+    uint32_t acked = packet.firstFrame;
+    if (acked > client.inputAcked) client.inputAcked = acked;
+    if (acked > client.inputCount) client.inputCount = acked;
+
+    const MatchSnapshot& snapshot = client.snapshot;
+    if (client.playing && snapshot.tick < client.lastTick) return; // Gói cũ đến sau
+    client.playing = true;
+    client.lastTick = snapshot.tick;
+    if (snapshot.gameEnded) {
+        result.ticks = snapshot.tick;
+        result.winner = snapshot.winner;
+        markDone(client);
+        return;
+    }
+
+    const SnapshotPlayer& self = snapshot.players[client.player];
+    const SnapshotPlayer& target = snapshot.players[1 - client.player];
+    BotView view;
+    view.active = (self.flags & SNAPSHOT_DEAD) == 0;
+    view.type = static_cast<CharacterType>(self.type);
+    view.selfX = snapshotX(self.x);
+    view.selfY = snapshotY(self.y);
+    view.targetX = snapshotX(target.x);
+    view.targetY = snapshotY(target.y);
+    view.reach = snapshotSize(self.size) * CHARACTER_SCALE;
+    view.speed = snapshotSpeed(self.speed);
+    while (client.inputCount <= snapshot.tick + inputLead &&
+        client.inputCount - client.inputAcked < static_cast<uint32_t>(MAX_SERVER_INPUTS_PER_PACKET)) {
+        client.inputs[client.inputCount++ & (BOT_INPUT_HISTORY - 1)] = client.bot.think(view);
+    }
+    sendInputs(client);
+}
+
+void BotClientGroup::sendJoin(Client& client, double now) {
+    ServerPacket packet;
+    packet.type = PACKET_JOIN;
+    packet.matchId = client.matchId;
+    packet.player = static_cast<uint8_t>(client.player);
+    packet.character = static_cast<uint8_t>(client.character);
+    uint8_t buffer[MAX_UDP_PACKET_SIZE];
+    client.socket.send(client.server, buffer, writeServerPacket(packet, buffer));
+    client.lastJoinAt = now;
+}
+
+void BotClientGroup::sendInputs(Client& client) {
+    // Gửi lại mọi input server chưa xác nhận, mất gói chỉ làm input đến muộn hơn. Không có
+    // input mới vẫn gửi để báo snapshot đã nhận
+    ServerPacket packet;
+    packet.type = PACKET_INPUT;
+    packet.matchId = client.matchId;
+    packet.player = static_cast<uint8_t>(client.player);
+    packet.snapshotAck = client.lastTick;
+    packet.firstFrame = client.inputAcked;
+    packet.inputCount = static_cast<uint8_t>(std::min<uint32_t>(client.inputCount - client.inputAcked, MAX_SERVER_INPUTS_PER_PACKET));
+    for (int i = 0; i < packet.inputCount; ++i) {
+        packet.buttons[i] = client.inputs[(client.inputAcked + i) & (BOT_INPUT_HISTORY - 1)];
+    }
+    uint8_t buffer[MAX_UDP_PACKET_SIZE];
+    client.socket.send(client.server, buffer, writeServerPacket(packet, buffer));
+}
+
+void BotClientGroup::markDone(Client& client) {
+    client.done = true;
+    --remaining;
+    uint32_t index = client.matchId - firstMatchId;
+    const Client& opponent = *clients[index * 2 + (1 - client.player)];
+    BotMatchResult& result = matchResults[index];
+    result.finished = opponent.done && !result.rejected;
+}
@@ -0,0 +1,58 @@
+﻿#ifndef BOT_CLIENT_HPP
+#define BOT_CLIENT_HPP
+
+#include "match_bot.hpp"
+#include "udp_socket.hpp"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Những gì hai client bot của một trận thấy được
+struct BotMatchResult {
+    uint32_t matchId = 0;
+    bool finished = false;  // Cả hai client đã nhận snapshot cuối
+    bool rejected = false;  // Server từ chối (đầy hoặc trùng vai)
+    uint32_t ticks = 0;     // Theo snapshot cuối
+    int winner = 0;
+    uint32_t snapshots = 0; // Số snapshot nhận được, cộng cả hai client
+    uint64_t snapshotBytes = 0;
+};
+
+// Nhiều client bot trên một thread, dùng để thử tải dedicated server qua loopback. Mỗi người
+// chơi có socket UDP riêng như một máy thật; mọi socket được chờ chung bằng một NetPoller.
+// Bot quyết định theo snapshot gần nhất và gửi trước input cho inputLead frame sau tick
+// của snapshot đó, để input đến server trước khi tick của nó chạy.
+class BotClientGroup {
+public:
+    BotClientGroup();
+    ~BotClientGroup();
+
+    // Hai client cho mỗi trận firstMatchId .. firstMatchId + matchCount - 1; tướng của trận
+    // lần lượt xoay qua bốn cặp đấu theo matchId. false nếu không mở được socket
+    bool start(const NetAddress& server, uint32_t firstMatchId, int matchCount, BotPolicy policy,
+        uint64_t seed, int inputLead);
+    // Chạy đến khi mọi trận đã xong hoặc quá timeoutSeconds; false nếu hết giờ trước
+    bool run(double timeoutSeconds);
+
+    const std::vector<BotMatchResult>& results() const { return matchResults; }
+
+private:
+    struct Client;
+
+    void handlePacket(Client& client, const uint8_t* data, size_t size, double now);
+    void sendJoin(Client& client, double now);
+    void sendInputs(Client& client);
+    void markDone(Client& client);
+
+    uint32_t firstMatchId = 0;
+    int inputLead = 3;
+    int remaining = 0; // Số client chưa xong
+    std::vector<std::unique_ptr<Client>> clients;
+    std::vector<BotMatchResult> matchResults;
+    NetPoller poller;
+
+    BotClientGroup(const BotClientGroup&) = delete;
+    BotClientGroup& operator=(const BotClientGroup&) = delete;
+};
+
+#endif // BOT_CLIENT_HPP
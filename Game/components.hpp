@@ -0,0 +1,98 @@
+﻿#ifndef COMPONENTS_HPP
+#define COMPONENTS_HPP
+
+#include <cstdint>
+
+// Các component của EntityStore: chỉ là dữ liệu POD, logic nằm ở các hàm system trong character.cpp.
+// Component không có byte đệm ngầm (phần đệm được khai báo thành trường và khởi tạo bằng 0)
+// vì MatchState được băm theo từng byte để phát hiện lệch trạng thái.
+
+struct Color {
+    float r, g, b, a;
+};
+
+// Nguồn sát thương, dùng để thống kê cân bằng tướng
+enum DamageSource {
+    DAMAGE_MELEE,          // Đòn đánh thường của DauSi
+    DAMAGE_COMBO,          // Đòn combo thứ 3
+    DAMAGE_ARROW,          // Mũi tên thường của XaThu
+    DAMAGE_CHARGED_ARROW,  // Mũi tên tụ lực đủ lâu
+    DAMAGE_SKILL,          // Skill Q
+    DAMAGE_SOURCE_COUNT
+};
+
+enum CharacterType { XA_THU = 0, DAU_SI = 1 };
+
+enum BuffType { BUFF_DAMAGE_BOOST, BUFF_HEAL, BUFF_SHIELD, BUFF_SPEED };
+
+struct Transform {
+    float x, y;
+    float prevX, prevY; // Vị trí ở tick trước, dùng để nội suy khi vẽ
+    float size;         // Cạnh hộp va chạm trước khi nhân CHARACTER_SCALE
+    bool facingRight;
+    uint8_t padding[3];
+};
+
+const int MAX_DAMAGE_NUMBERS = 16; // Số hiện sống 1 giây nên 16 là dư; khi đầy bỏ số cũ nhất
+
+struct DamageNumber {
+    float value;
+    float x, y;
+    float time;
+};
+
+struct Health {
+    float health;
+    float maxHealth;
+    bool shielded;
+    bool isDead;
+    uint8_t padding[2];
+    int damageNumberCount;
+    DamageNumber damageNumbers[MAX_DAMAGE_NUMBERS]; // [0, damageNumberCount), cũ nhất trước
+};
+
+struct Cooldowns {
+    float attackCooldown, lastAttackTime;
+    float skillCooldown, lastSkillTime;
+    float dodgeCooldown, lastDodgeTime;
+    float comboWindow, lastComboTime;
+};
+
+// Trạng thái chiến đấu riêng của nhân vật điều khiển được
+struct Fighter {
+    CharacterType type;
+    int playerIndex;
+    Color color;
+    float speed;
+    float attackDamage;
+    float attackRange;
+    bool isDodging;
+    uint8_t padding[3];
+    int comboCount;
+    float chargeTime; // Chỉ XaThu dùng
+    float damageDealt[DAMAGE_SOURCE_COUNT];
+};
+
+// Tín hiệu mô phỏng gửi cho renderer để chọn animation
+struct AnimationState {
+    float attackStartTime; // Thời điểm bắt đầu đòn đánh gần nhất, -1 nếu chưa đánh
+    bool isMoving;
+    uint8_t padding[3];
+};
+
+struct Buff {
+    BuffType type;
+    Color color;
+};
+
+// Handle trong SpatialHash của trận
+struct Collider {
+    int handle;
+};
+
+static_assert(sizeof(Transform) == 6 * 4, "Transform has implicit padding");
+static_assert(sizeof(Health) == 4 * 4 + sizeof(DamageNumber) * MAX_DAMAGE_NUMBERS, "Health has implicit padding");
+static_assert(sizeof(Fighter) == 8 * 4 + sizeof(Color) + 4 * DAMAGE_SOURCE_COUNT, "Fighter has implicit padding");
+static_assert(sizeof(AnimationState) == 2 * 4, "AnimationState has implicit padding");
+
+#endif // COMPONENTS_HPP
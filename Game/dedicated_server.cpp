@@ -0,0 +1,308 @@
+﻿#include "match_server.hpp"
+#include "bot_client.hpp"
+#include "logger.hpp"
+#include "profiler.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Dedicated server có thẩm quyền cho các trận PvP, không cần GLFW/GLEW/ImGui.
+// Ví dụ thử tải qua loopback: dedicated_server --workers 4 --bots 300
+// Client bot tới server ở máy khác: dedicated_server --connect 10.0.0.5:7777 --bots 100
+
+struct DedicatedOptions {
+    ServerOptions server;
+    int bots = 0;               // Số trận bot, 0 = chỉ chạy server
+    unsigned botThreads = 2;
+    BotPolicy botPolicy = BOT_SCRIPTED;
+    int inputLead = 3;
+    std::string connect;        // Chỉ chạy client bot tới server này
+    double duration = 0.0;      // Giây; 0 = đến khi Ctrl+C hoặc bot chơi xong
+    std::string recordDir;
+    std::string tracePath;
+};
+
+static std::atomic<bool> stopRequested(false);
+
+static void onSignal(int) {
+    stopRequested.store(true);
+}
+
+static bool parseBot(const char* text, BotPolicy& policy) {
+    if (std::strcmp(text, "scripted") == 0) policy = BOT_SCRIPTED;
+    else if (std::strcmp(text, "random") == 0) policy = BOT_RANDOM;
+    else if (std::strcmp(text, "idle") == 0) policy = BOT_IDLE;
+    else return false;
+    return true;
+}
+
+static void printUsage() {
+    std::fprintf(stderr,
+        "Usage: dedicated_server [options]\n"
+        "  --port N               cong UDP dau tien, worker i nghe o port + i (mac dinh 7777)\n"
+        "  --workers N            so worker thread, 0 = tat ca nhan CPU (mac dinh 0)\n"
+        "  --max-matches N        so tran toi da moi worker (mac dinh 128)\n"
+        "  --seed N               seed goc cua cac tran (mac dinh 1)\n"
+        "  --max-ticks N          so tick toi da moi tran, het gio tinh hoa\n"
+        "  --snapshot-interval N  gui snapshot moi N tick (mac dinh 2)\n"
+        "  --no-pin               khong gan worker vao nhan CPU\n"
+        "  --duration S           dung sau S giay (mac dinh: den khi Ctrl+C hoac bot choi xong)\n"
+        "  --record DIR           ghi replay cua tung tran vao DIR/server_NNNNNNNN.lqr\n"
+        "  --trace PATH           ghi profile dang Chrome trace\n"
+        "  --bots N               choi N tran bot qua loopback roi thoat\n"
+        "  --bot-threads N        so thread cho client bot (mac dinh 2)\n"
+        "  --bot-policy NAME      scripted | random | idle\n"
+        "  --input-lead N         bot gui input truoc N frame (mac dinh 3)\n"
+        "  --connect HOST:PORT    chi chay client bot toi server nay\n");
+}
+
+static bool parseOptions(int argc, char** argv, DedicatedOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        if (std::strcmp(arg, "--no-pin") == 0) {
+            options.server.pinThreads = false;
+            continue;
+        }
+        const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (!value) return false;
+        if (std::strcmp(arg, "--port") == 0) options.server.port = static_cast<uint16_t>(std::atoi(value));
+        else if (std::strcmp(arg, "--workers") == 0) options.server.workers = static_cast<unsigned>(std::atoi(value));
+        else if (std::strcmp(arg, "--max-matches") == 0) options.server.maxMatchesPerWorker = std::atoi(value);
+        else if (std::strcmp(arg, "--seed") == 0) options.server.seed = std::strtoull(value, nullptr, 10);
+        else if (std::strcmp(arg, "--max-ticks") == 0) options.server.maxTicks = static_cast<uint32_t>(std::atoi(value));
+        else if (std::strcmp(arg, "--snapshot-interval") == 0) options.server.snapshotInterval = std::atoi(value);
+        else if (std::strcmp(arg, "--duration") == 0) options.duration = std::atof(value);
+        else if (std::strcmp(arg, "--record") == 0) options.recordDir = value;
+        else if (std::strcmp(arg, "--trace") == 0) options.tracePath = value;
+        else if (std::strcmp(arg, "--bots") == 0) options.bots = std::atoi(value);
+        else if (std::strcmp(arg, "--bot-threads") == 0) options.botThreads = static_cast<unsigned>(std::atoi(value));
+        else if (std::strcmp(arg, "--bot-policy") == 0) { if (!parseBot(value, options.botPolicy)) return false; }
+        else if (std::strcmp(arg, "--input-lead") == 0) options.inputLead = std::atoi(value);
+        else if (std::strcmp(arg, "--connect") == 0) options.connect = value;
+        else return false;
+        ++i;
+    }
+    options.server.recordReplays = !options.recordDir.empty();
+    options.botThreads = std::max(1u, options.botThreads);
+    return options.server.port > 0 && options.server.maxMatchesPerWorker > 0 && options.bots >= 0 &&
+        (options.connect.empty() || options.bots > 0);
+}
+
+// Cộng dồn báo cáo của các trận đã xong
+struct ServerSummary {
+    size_t matches = 0;
+    size_t abandoned = 0;
+    uint64_t ticks = 0;
+    uint64_t overruns = 0;
+    size_t matchesWithOverruns = 0;
+    uint64_t missingInputs = 0;
+    double totalStepUs = 0.0;
+    double maxStepUs = 0.0;
+    double maxLateMs = 0.0;
+};
+
+static void collectReports(MatchServer& server, const DedicatedOptions& options, ServerSummary& summary,
+    std::vector<ServerMatchReport>& finished) {
+    size_t first = finished.size();
+    server.takeReports(finished);
+    for (size_t i = first; i < finished.size(); ++i) {
+        ServerMatchReport& report = finished[i];
+        ++summary.matches;
+        if (report.abandoned) ++summary.abandoned;
+        summary.ticks += report.ticks;
+        summary.overruns += report.overruns;
+        if (report.overruns > 0) ++summary.matchesWithOverruns;
+        summary.missingInputs += report.missingInputs[0] + report.missingInputs[1];
+        summary.totalStepUs += report.avgStepUs * report.ticks;
+        summary.maxStepUs = std::max(summary.maxStepUs, report.maxStepUs);
+        summary.maxLateMs = std::max(summary.maxLateMs, report.maxLateMs);
+
+        if (options.server.recordReplays) {
+            char name[32];
+            std::snprintf(name, sizeof(name), "/server_%08u.lqr", report.matchId);
+            if (!saveReplay(options.recordDir + name, report.replay)) {
+                LOG_ERROR("Could not write replay {}{}", options.recordDir, name);
+            }
+            report.replay = Replay(); // Không giữ input của cả giải trong bộ nhớ
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    DedicatedOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return 1;
+    }
+
+    Logger::instance().setLevel(LOG_LEVEL_INFO);
+    Profiler::setThreadName("Main");
+    Profiler::instance().setEnabled(!options.tracePath.empty());
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+    if (!options.recordDir.empty()) {
+        std::error_code error;
+        std::filesystem::create_directories(options.recordDir, error);
+    }
+
+    bool clientOnly = !options.connect.empty();
+    NetAddress serverAddress;
+    serverAddress.ip = 0x7F000001; // 127.0.0.1
+    serverAddress.port = options.server.port;
+    if (clientOnly && !parseAddress(options.connect, serverAddress)) {
+        std::fprintf(stderr, "Bad server address %s\n", options.connect.c_str());
+        return 1;
+    }
+
+    MatchServer server;
+    if (!clientOnly && !server.start(options.server)) return 1;
+
+    // Client bot chia đều các trận giữa các thread, mỗi thread một BotClientGroup
+    std::vector<std::unique_ptr<BotClientGroup>> botGroups;
+    std::vector<std::thread> botThreads;
+    std::atomic<unsigned> botThreadsRunning(0);
+    if (options.bots > 0) {
+        unsigned threads = std::min<unsigned>(options.botThreads, options.bots);
+        double timeout = options.duration > 0.0 ? options.duration : 2.0 * options.server.maxTicks * TICK_DT + 30.0;
+        for (unsigned t = 0; t < threads; ++t) {
+            int first = options.bots * t / threads;
+            int last = options.bots * (t + 1) / threads;
+            std::unique_ptr<BotClientGroup> group(new BotClientGroup());
+            if (!group->start(serverAddress, static_cast<uint32_t>(first), last - first, options.botPolicy,
+                    options.server.seed, options.inputLead)) {
+                return 1;
+            }
+            botGroups.push_back(std::move(group));
+        }
+        std::fprintf(stderr, "Running %d bot matches against %s on %u threads\n", options.bots,
+            formatAddress(serverAddress).c_str(), threads);
+        botThreadsRunning.store(threads);
+        for (std::unique_ptr<BotClientGroup>& group : botGroups) {
+            BotClientGroup* g = group.get();
+            botThreads.emplace_back([g, timeout, &botThreadsRunning] {
+                Profiler::setThreadName("Bot clients");
+                if (!g->run(timeout)) LOG_WARN("Bot clients timed out");
+                botThreadsRunning.fetch_sub(1);
+            });
+        }
+    }
+
+    ServerSummary summary;
+    std::vector<ServerMatchReport> finished;
+    auto startTime = std::chrono::steady_clock::now();
+    auto lastStatus = startTime;
+    uint64_t lastTicks = 0;
+    while (!stopRequested.load()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        auto now = std::chrono::steady_clock::now();
+        double elapsed = std::chrono::duration<double>(now - startTime).count();
+        if (options.bots > 0 && botThreadsRunning.load() == 0) break;
+        if (options.duration > 0.0 && elapsed >= options.duration) break;
+        if (clientOnly) continue;
+
+        collectReports(server, options, summary, finished);
+        double sinceStatus = std::chrono::duration<double>(now - lastStatus).count();
+        if (sinceStatus < 1.0) continue;
+        uint32_t active = 0;
+        uint64_t ticks = 0, overruns = 0, received = 0, sent = 0;
+        for (unsigned w = 0; w < server.workerCount(); ++w) {
+            const ServerWorkerStats& stats = server.workerStats(w);
+            active += stats.activeMatches.load(std::memory_order_relaxed);
+            ticks += stats.ticks.load(std::memory_order_relaxed);
+            overruns += stats.overruns.load(std::memory_order_relaxed);
+            received += stats.packetsReceived.load(std::memory_order_relaxed);
+            sent += stats.packetsSent.load(std::memory_order_relaxed);
+        }
+        std::fprintf(stderr, "[%5.0f s] %u active, %zu finished, %.0f ticks/s, %llu overruns, %llu packets in, %llu out\n",
+            elapsed, active, summary.matches, (ticks - lastTicks) / sinceStatus, static_cast<unsigned long long>(overruns),
+            static_cast<unsigned long long>(received), static_cast<unsigned long long>(sent));
+        lastTicks = ticks;
+        lastStatus = now;
+    }
+
+    for (std::thread& thread : botThreads) thread.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    // stop() chờ các worker xong vòng hiện tại, nên báo cáo của những trận vừa xong đều đã có
+    if (!clientOnly) {
+        server.stop();
+        collectReports(server, options, summary, finished);
+    }
+
+    int exitCode = 0;
+    if (!clientOnly) {
+        std::printf("Server: %zu matches finished (%zu abandoned), %llu ticks in %.1f s\n", summary.matches,
+            summary.abandoned, static_cast<unsigned long long>(summary.ticks), seconds);
+        std::printf("  step: %.2f us avg, %.2f us max; latest tick start %.2f ms after schedule\n",
+            summary.ticks > 0 ? summary.totalStepUs / summary.ticks : 0.0, summary.maxStepUs, summary.maxLateMs);
+        std::printf("  tick budget overruns: %llu ticks in %zu matches (budget %.2f ms per tick)\n",
+            static_cast<unsigned long long>(summary.overruns), summary.matchesWithOverruns, TICK_DT * 1e3);
+        std::printf("  inputs missing at their tick: %llu (%.3f%% of player ticks)\n",
+            static_cast<unsigned long long>(summary.missingInputs),
+            summary.ticks > 0 ? 100.0 * summary.missingInputs / (2.0 * summary.ticks) : 0.0);
+        for (unsigned w = 0; w < server.workerCount(); ++w) {
+            const ServerWorkerStats& stats = server.workerStats(w);
+            std::printf("  worker %u: %llu ticks, %llu overruns, busy %.1f%%, %llu packets in (%llu rejected), %llu out\n", w,
+                static_cast<unsigned long long>(stats.ticks.load()), static_cast<unsigned long long>(stats.overruns.load()),
+                100.0 * stats.busyMicros.load() * 1e-6 / seconds,
+                static_cast<unsigned long long>(stats.packetsReceived.load()),
+                static_cast<unsigned long long>(stats.packetsRejected.load()),
+                static_cast<unsigned long long>(stats.packetsSent.load()));
+        }
+
+        // Trận có nhiều tick quá hạn nhất
+        std::sort(finished.begin(), finished.end(), [](const ServerMatchReport& a, const ServerMatchReport& b) {
+            return a.overruns > b.overruns;
+        });
+        for (size_t i = 0; i < finished.size() && i < 5 && finished[i].overruns > 0; ++i) {
+            const ServerMatchReport& report = finished[i];
+            std::printf("  match %u (worker %u): %u of %u ticks over budget, max step %.1f us, max late %.2f ms\n",
+                report.matchId, report.worker, report.overruns, report.ticks, report.maxStepUs, report.maxLateMs);
+        }
+    }
+
+    if (options.bots > 0) {
+        // Kết quả client thấy trong snapshot cuối phải khớp với báo cáo của server
+        std::vector<const ServerMatchReport*> byMatch(options.bots, nullptr);
+        for (const ServerMatchReport& report : finished) {
+            if (report.matchId < static_cast<uint32_t>(options.bots)) byMatch[report.matchId] = &report;
+        }
+        int completed = 0, disagreed = 0;
+        uint64_t snapshots = 0, snapshotBytes = 0;
+        for (const std::unique_ptr<BotClientGroup>& group : botGroups) {
+            for (const BotMatchResult& result : group->results()) {
+                snapshots += result.snapshots;
+                snapshotBytes += result.snapshotBytes;
+                if (!result.finished) continue;
+                ++completed;
+                const ServerMatchReport* report = byMatch[result.matchId];
+                if (!clientOnly && (!report || report->ticks != result.ticks || report->winner != result.winner)) {
+                    ++disagreed;
+                }
+            }
+        }
+        std::printf("Bots: %d of %d matches completed, %llu snapshots (%.0f bytes avg)", completed, options.bots,
+            static_cast<unsigned long long>(snapshots), snapshots > 0 ? static_cast<double>(snapshotBytes) / snapshots : 0.0);
+        if (!clientOnly) std::printf(", %d disagree with the server", disagreed);
+        std::printf("\n");
+        if (completed != options.bots || disagreed > 0) exitCode = 1;
+    }
+
+    if (!options.tracePath.empty()) {
+        Profiler& profiler = Profiler::instance();
+        profiler.setEnabled(false);
+        if (!profiler.writeChromeTrace(options.tracePath)) {
+            std::fprintf(stderr, "Could not write trace to %s\n", options.tracePath.c_str());
+            return 1;
+        }
+    }
+    Logger::instance().flush();
+    return exitCode;
+}
@@ -0,0 +1,46 @@
+﻿#include "entity_store.hpp"
+
+void EntityStore::clear() {
+    transforms.clear();
+    healths.clear();
+    cooldowns.clear();
+    fighters.clear();
+    animations.clear();
+    buffs.clear();
+    colliders.clear();
+    freeCount = 0;
+    nextIndex = 0;
+}
+
+EntityId EntityStore::create() {
+    uint32_t index;
+    if (freeCount > 0) {
+        index = freeIndices[--freeCount];
+    }
+    else {
+        if (nextIndex >= static_cast<uint32_t>(MAX_MATCH_ENTITIES)) return NO_ENTITY;
+        index = nextIndex++;
+        generations[index] = 0;
+    }
+    return index | (generations[index] << ENTITY_INDEX_BITS);
+}
+
+void EntityStore::destroy(EntityId entity) {
+    if (!isAlive(entity)) return;
+    transforms.remove(entity);
+    healths.remove(entity);
+    cooldowns.remove(entity);
+    fighters.remove(entity);
+    animations.remove(entity);
+    buffs.remove(entity);
+    colliders.remove(entity);
+    uint32_t index = entityIndex(entity);
+    generations[index] = (generations[index] + 1) & (0xFFFFFFFFu >> ENTITY_INDEX_BITS);
+    freeIndices[freeCount++] = index;
+}
+
+bool EntityStore::isAlive(EntityId entity) const {
+    if (entity == NO_ENTITY) return false;
+    uint32_t index = entityIndex(entity);
+    return index < nextIndex && (entity >> ENTITY_INDEX_BITS) == generations[index];
+}
@@ -0,0 +1,110 @@
+﻿#ifndef ENTITY_STORE_HPP
+#define ENTITY_STORE_HPP
+
+#include "components.hpp"
+#include "game_config.hpp"
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// 20 bit thấp là chỉ số, 12 bit cao là thế hệ để id cũ của entity đã xóa không trỏ nhầm sang entity mới
+typedef uint32_t EntityId;
+const EntityId NO_ENTITY = 0xFFFFFFFFu;
+const int ENTITY_INDEX_BITS = 20;
+const uint32_t ENTITY_INDEX_MASK = (1u << ENTITY_INDEX_BITS) - 1;
+
+inline uint32_t entityIndex(EntityId entity) { return entity & ENTITY_INDEX_MASK; }
+
+// Sparse set: component nằm liền nhau trong dense theo thứ tự thêm vào, sparse ánh xạ
+// chỉ số entity sang vị trí trong dense. Xóa bằng cách đưa phần tử cuối vào chỗ trống,
+// nên các system duyệt [0, size()) không bao giờ gặp lỗ hổng.
+// Các mảng có sức chứa cố định MAX_MATCH_ENTITIES nằm ngay trong đối tượng, không có con trỏ,
+// nên thêm/xóa không bao giờ cấp phát và cả store sao chép được bằng memcpy.
+template <typename T>
+class ComponentArray {
+    static_assert(std::is_trivially_copyable<T>::value, "components are moved with plain copies");
+
+public:
+    static constexpr uint32_t CAPACITY = MAX_MATCH_ENTITIES;
+
+    void clear() {
+        std::memset(sparse, 0xFF, sizeof(sparse));
+        count = 0;
+    }
+
+    // entity phải là id hợp lệ (không phải NO_ENTITY) và mảng còn chỗ
+    T& add(EntityId entity, const T& value) {
+        assert(entityIndex(entity) < CAPACITY && count < CAPACITY);
+        uint32_t slot = count++;
+        sparse[entityIndex(entity)] = slot;
+        dense[slot] = value;
+        entities[slot] = entity;
+        return dense[slot];
+    }
+
+    void remove(EntityId entity) {
+        if (!has(entity)) return;
+        uint32_t slot = sparse[entityIndex(entity)];
+        uint32_t last = --count;
+        if (slot != last) {
+            dense[slot] = dense[last];
+            entities[slot] = entities[last];
+            sparse[entityIndex(entities[slot])] = slot;
+        }
+        sparse[entityIndex(entity)] = EMPTY_SLOT;
+    }
+
+    bool has(EntityId entity) const {
+        uint32_t index = entityIndex(entity);
+        return index < CAPACITY && sparse[index] < count && entities[sparse[index]] == entity;
+    }
+
+    // entity phải có component này
+    T& get(EntityId entity) { return dense[sparse[entityIndex(entity)]]; }
+    const T& get(EntityId entity) const { return dense[sparse[entityIndex(entity)]]; }
+
+    size_t size() const { return count; }
+    T& operator[](size_t slot) { return dense[slot]; }
+    const T& operator[](size_t slot) const { return dense[slot]; }
+    EntityId entityAt(size_t slot) const { return entities[slot]; }
+
+private:
+    static constexpr uint32_t EMPTY_SLOT = 0xFFFFFFFFu;
+
+    T dense[CAPACITY];
+    EntityId entities[CAPACITY]; // entities[i] sở hữu dense[i]
+    uint32_t sparse[CAPACITY];
+    uint32_t count;
+};
+
+// Mọi entity của một trận và component của chúng, tối đa MAX_MATCH_ENTITIES entity
+class EntityStore {
+public:
+    // Bỏ mọi entity mà không duyệt qua chúng, bắt đầu đánh số lại từ 0
+    // để cùng một trận luôn cho ra cùng các id
+    void clear();
+
+    // NO_ENTITY nếu đã đủ MAX_MATCH_ENTITIES entity
+    EntityId create();
+    // Xóa entity cùng mọi component của nó; chỉ số được dùng lại qua free list
+    void destroy(EntityId entity);
+    bool isAlive(EntityId entity) const;
+
+    ComponentArray<Transform> transforms;
+    ComponentArray<Health> healths;
+    ComponentArray<Cooldowns> cooldowns;
+    ComponentArray<Fighter> fighters;
+    ComponentArray<AnimationState> animations;
+    ComponentArray<Buff> buffs;
+    ComponentArray<Collider> colliders;
+
+private:
+    uint32_t generations[MAX_MATCH_ENTITIES]; // Theo chỉ số entity, hợp lệ trong [0, nextIndex)
+    uint32_t freeIndices[MAX_MATCH_ENTITIES];
+    uint32_t freeCount;
+    uint32_t nextIndex;
+};
+
+#endif // ENTITY_STORE_HPP
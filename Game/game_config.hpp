@@ -0,0 +1,17 @@
+﻿#ifndef GAME_CONFIG_HPP
+#define GAME_CONFIG_HPP
+
+constexpr float CHARACTER_SCALE = 8.0f;
+constexpr float WINDOW_WIDTH = 1500.0f;
+constexpr float WINDOW_HEIGHT = 900.0f;
+constexpr float GRAVITY = 0.0f;
+
+// Mô phỏng chạy theo tick cố định, không phụ thuộc tốc độ khung hình
+constexpr int TICK_RATE = 60;
+constexpr float TICK_DT = 1.0f / TICK_RATE;
+
+// Sức chứa cố định của một trận, quyết định kích thước MatchState
+constexpr int MAX_BUFFS = 64; // Buff nằm trên sân cùng lúc; đủ thì bỏ lượt sinh
+constexpr int MAX_MATCH_ENTITIES = 2 + MAX_BUFFS;
+
+#endif // GAME_CONFIG_HPP
@@ -0,0 +1,107 @@
+﻿#include "gpu_timer.hpp"
+#include "logger.hpp"
+#include <cstring>
+
+static const char* PASS_NAMES[GPU_PASS_COUNT] = { "GPU background", "GPU world", "GPU UI" };
+
+// Renderer chạy trên CPU: query có trả về nhưng không phải thời gian GPU thật
+static bool isSoftwareRenderer(const char* renderer) {
+    static const char* SOFTWARE_RENDERERS[] = { "llvmpipe", "softpipe", "SwiftShader", "Microsoft Basic Render", "GDI Generic" };
+    if (!renderer) return false;
+    for (const char* name : SOFTWARE_RENDERERS) {
+        if (std::strstr(renderer, name)) return true;
+    }
+    return false;
+}
+
+GpuTimer::GpuTimer() : slot(0), activePass(-1), supported(false), emulated(false), skipped(0) {
+    std::memset(queries, 0, sizeof(queries));
+    std::memset(issued, 0, sizeof(issued));
+    std::memset(fresh, 0, sizeof(fresh));
+    for (float& ms : resultMs) ms = 0.0f;
+}
+
+bool GpuTimer::init() {
+    if (!GLEW_VERSION_3_3 && !GLEW_ARB_timer_query) {
+        LOG_WARN("GPU timer queries not supported, GPU pass timings disabled");
+        return false;
+    }
+    // Một số driver có extension nhưng bộ đếm 0 bit, nghĩa là không đo được
+    GLint counterBits = 0;
+    glGetQueryiv(GL_TIME_ELAPSED, GL_QUERY_COUNTER_BITS, &counterBits);
+    if (counterBits == 0 || glGetError() != GL_NO_ERROR) {
+        LOG_WARN("GL_TIME_ELAPSED has no counter bits, GPU pass timings disabled");
+        return false;
+    }
+
+    glGenQueries(GPU_TIMER_FRAMES * GPU_PASS_COUNT, &queries[0][0]);
+    if (glGetError() != GL_NO_ERROR) {
+        LOG_WARN("Could not create GPU timer queries, GPU pass timings disabled");
+        std::memset(queries, 0, sizeof(queries));
+        return false;
+    }
+
+    const char* renderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+    emulated = isSoftwareRenderer(renderer);
+    if (emulated) {
+        LOG_INFO("Software renderer {}: GPU pass timings are CPU-emulated", renderer);
+    }
+    supported = true;
+    return true;
+}
+
+void GpuTimer::shutdown() {
+    if (supported) {
+        if (activePass >= 0) glEndQuery(GL_TIME_ELAPSED);
+        glDeleteQueries(GPU_TIMER_FRAMES * GPU_PASS_COUNT, &queries[0][0]);
+    }
+    std::memset(queries, 0, sizeof(queries));
+    std::memset(issued, 0, sizeof(issued));
+    activePass = -1;
+    supported = false;
+}
+
+void GpuTimer::beginFrame() {
+    std::memset(fresh, 0, sizeof(fresh));
+    if (!supported) return;
+
+    slot = (slot + 1) % GPU_TIMER_FRAMES;
+    for (int pass = 0; pass < GPU_PASS_COUNT; ++pass) {
+        if (!issued[slot][pass]) continue;
+        issued[slot][pass] = false;
+        GLint available = 0;
+        glGetQueryObjectiv(queries[slot][pass], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) {
+            // Đọc lúc này sẽ chặn CPU tới khi GPU xong; bỏ mẫu này, query được dùng lại bình thường
+            ++skipped;
+            continue;
+        }
+        GLuint64 elapsedNanos = 0;
+        glGetQueryObjectui64v(queries[slot][pass], GL_QUERY_RESULT, &elapsedNanos);
+        resultMs[pass] = static_cast<float>(elapsedNanos / 1e6);
+        fresh[pass] = true;
+    }
+}
+
+void GpuTimer::begin(GpuPass pass) {
+    if (!supported || activePass >= 0) return;
+    glBeginQuery(GL_TIME_ELAPSED, queries[slot][pass]);
+    activePass = pass;
+}
+
+void GpuTimer::end(GpuPass pass) {
+    if (activePass != pass) return;
+    glEndQuery(GL_TIME_ELAPSED);
+    issued[slot][pass] = true;
+    activePass = -1;
+}
+
+bool GpuTimer::newResult(GpuPass pass, float& ms) const {
+    if (!fresh[pass]) return false;
+    ms = resultMs[pass];
+    return true;
+}
+
+const char* GpuTimer::passName(GpuPass pass) {
+    return PASS_NAMES[pass];
+}
@@ -0,0 +1,57 @@
+﻿#ifndef GPU_TIMER_HPP
+#define GPU_TIMER_HPP
+
+#include <GL/glew.h>
+#include <cstdint>
+
+// Các pass vẽ được đo, theo thứ tự trong một frame
+enum GpuPass {
+    GPU_PASS_BACKGROUND = 0,
+    GPU_PASS_WORLD = 1,
+    GPU_PASS_UI = 2,
+    GPU_PASS_COUNT
+};
+
+// Số bộ query xoay vòng: kết quả của frame N được đọc ở đầu frame N + 3,
+// lúc đó GPU thường đã xong nên không bao giờ phải chờ
+const int GPU_TIMER_FRAMES = 3;
+
+// Đo thời gian GPU của từng pass bằng query GL_TIME_ELAPSED.
+// Nếu driver không hỗ trợ, mọi hàm đều không làm gì. Trên renderer phần mềm (llvmpipe...)
+// query vẫn chạy nhưng chỉ là thời gian CPU giả lập, isEmulated() báo để HUD ghi chú.
+class GpuTimer {
+public:
+    GpuTimer();
+
+    // Gọi sau khi có context OpenGL; false nếu không đo được
+    bool init();
+    void shutdown();
+
+    // Đầu mỗi frame: lấy kết quả của bộ query cũ nhất rồi dùng lại nó cho frame này
+    void beginFrame();
+    // begin/end không được lồng nhau (GL chỉ cho một query GL_TIME_ELAPSED chạy cùng lúc)
+    void begin(GpuPass pass);
+    void end(GpuPass pass);
+
+    bool isSupported() const { return supported; }
+    bool isEmulated() const { return emulated; }
+    // true nếu beginFrame() vừa đọc được kết quả mới cho pass, ghi vào ms
+    bool newResult(GpuPass pass, float& ms) const;
+    // Số kết quả bị bỏ vì GPU chưa xong khi tới lượt dùng lại query
+    uint64_t skippedCount() const { return skipped; }
+
+    static const char* passName(GpuPass pass);
+
+private:
+    GLuint queries[GPU_TIMER_FRAMES][GPU_PASS_COUNT];
+    bool issued[GPU_TIMER_FRAMES][GPU_PASS_COUNT];
+    float resultMs[GPU_PASS_COUNT];
+    bool fresh[GPU_PASS_COUNT];
+    int slot;
+    int activePass; // -1 nếu không có query đang chạy
+    bool supported;
+    bool emulated;
+    uint64_t skipped;
+};
+
+#endif // GPU_TIMER_HPP
@@ -0,0 +1,91 @@
+﻿#include "hash64.hpp"
+#include <cstring>
+
+static const uint64_t PRIME1 = 0x9E3779B185EBCA87ull;
+static const uint64_t PRIME2 = 0xC2B2AE3D27D4EB4Full;
+static const uint64_t PRIME3 = 0x165667B19E3779F9ull;
+static const uint64_t PRIME4 = 0x85EBCA77C2B2AE63ull;
+static const uint64_t PRIME5 = 0x27D4EB2F165667C5ull;
+
+static inline uint64_t rotl64(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+// Đọc không căn lề; memcpy được compiler biến thành một lệnh load
+static inline uint64_t read64(const unsigned char* p) {
+    uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static inline uint32_t read32(const unsigned char* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static inline uint64_t round64(uint64_t acc, uint64_t input) {
+    acc += input * PRIME2;
+    acc = rotl64(acc, 31);
+    return acc * PRIME1;
+}
+
+static inline uint64_t mergeRound(uint64_t acc, uint64_t value) {
+    acc ^= round64(0, value);
+    return acc * PRIME1 + PRIME4;
+}
+
+uint64_t xxHash64(const void* data, size_t size, uint64_t seed) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    const unsigned char* end = p + size;
+    uint64_t hash;
+
+    if (size >= 32) {
+        // Bốn làn độc lập để CPU chạy song song các phép nhân
+        uint64_t v1 = seed + PRIME1 + PRIME2;
+        uint64_t v2 = seed + PRIME2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - PRIME1;
+        const unsigned char* limit = end - 32;
+        do {
+            v1 = round64(v1, read64(p));
+            v2 = round64(v2, read64(p + 8));
+            v3 = round64(v3, read64(p + 16));
+            v4 = round64(v4, read64(p + 24));
+            p += 32;
+        } while (p <= limit);
+
+        hash = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18);
+        hash = mergeRound(hash, v1);
+        hash = mergeRound(hash, v2);
+        hash = mergeRound(hash, v3);
+        hash = mergeRound(hash, v4);
+    }
+    else {
+        hash = seed + PRIME5;
+    }
+    hash += static_cast<uint64_t>(size);
+
+    while (p + 8 <= end) {
+        hash ^= round64(0, read64(p));
+        hash = rotl64(hash, 27) * PRIME1 + PRIME4;
+        p += 8;
+    }
+    if (p + 4 <= end) {
+        hash ^= static_cast<uint64_t>(read32(p)) * PRIME1;
+        hash = rotl64(hash, 23) * PRIME2 + PRIME3;
+        p += 4;
+    }
+    while (p < end) {
+        hash ^= (*p) * PRIME5;
+        hash = rotl64(hash, 11) * PRIME1;
+        ++p;
+    }
+
+    hash ^= hash >> 33;
+    hash *= PRIME2;
+    hash ^= hash >> 29;
+    hash *= PRIME3;
+    hash ^= hash >> 32;
+    return hash;
+}
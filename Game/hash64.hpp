@@ -0,0 +1,12 @@
+﻿#ifndef HASH64_HPP
+#define HASH64_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// xxHash64 (thuật toán gốc của Yann Collet): băm nhanh cỡ tốc độ đọc bộ nhớ, dùng làm checksum
+// của MatchState để phát hiện lệch trạng thái giữa các máy hoặc giữa các lần chạy.
+// Không dùng cho mục đích bảo mật.
+uint64_t xxHash64(const void* data, size_t size, uint64_t seed = 0);
+
+#endif // HASH64_HPP
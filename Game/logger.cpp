@@ -0,0 +1,173 @@
+﻿#include "logger.hpp"
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+
+static const char* LEVEL_NAMES[] = { "TRACE", "DEBUG", "INFO", "WARN", "ERROR" };
+
+static int64_t nowMicros() {
+    static const auto start = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+Logger& Logger::instance() {
+    static Logger logger;
+    return logger;
+}
+
+Logger::Logger()
+    : slots(new Slot[LOG_QUEUE_SIZE]), enqueuePosition(0), dequeuePosition(0),
+    dropped(0), written(0), printed(0), minLevel(LOG_COMPILE_LEVEL), running(true) {
+    for (size_t i = 0; i < LOG_QUEUE_SIZE; ++i) {
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    nowMicros();
+    worker = std::thread(&Logger::run, this);
+}
+
+Logger::~Logger() {
+    running.store(false, std::memory_order_release);
+    worker.join();
+    delete[] slots;
+}
+
+// Hàng đợi vòng có số thứ tự trên từng ô (kiểu Vyukov): nhiều thread ghi tranh nhau
+// bằng CAS trên enqueuePosition, thread nền là nơi đọc duy nhất
+LogRecord* Logger::beginRecord(size_t& position) {
+    size_t pos = enqueuePosition.load(std::memory_order_relaxed);
+    for (;;) {
+        Slot& slot = slots[pos & (LOG_QUEUE_SIZE - 1)];
+        size_t sequence = slot.sequence.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+        if (diff == 0) {
+            if (enqueuePosition.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                position = pos;
+                slot.record.timeMicros = nowMicros();
+                return &slot.record;
+            }
+        }
+        else if (diff < 0) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        else {
+            pos = enqueuePosition.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void Logger::commitRecord(size_t position) {
+    written.fetch_add(1, std::memory_order_relaxed);
+    slots[position & (LOG_QUEUE_SIZE - 1)].sequence.store(position + 1, std::memory_order_release);
+}
+
+void Logger::captureInt(LogRecord& record, int64_t value) {
+    LogArg& arg = record.args[record.argCount++];
+    arg.type = LogArg::INT;
+    arg.i = value;
+}
+
+void Logger::captureUInt(LogRecord& record, uint64_t value) {
+    LogArg& arg = record.args[record.argCount++];
+    arg.type = LogArg::UINT;
+    arg.u = value;
+}
+
+void Logger::capture(LogRecord& record, double value) {
+    LogArg& arg = record.args[record.argCount++];
+    arg.type = LogArg::DOUBLE;
+    arg.d = value;
+}
+
+void Logger::capture(LogRecord& record, bool value) {
+    LogArg& arg = record.args[record.argCount++];
+    arg.type = LogArg::BOOL;
+    arg.u = value ? 1 : 0;
+}
+
+void Logger::captureText(LogRecord& record, const char* text, size_t length) {
+    // Chuỗi dài hơn chỗ còn lại bị cắt bớt
+    size_t room = LOG_TEXT_SIZE - record.textUsed;
+    if (length > room) length = room;
+    LogArg& arg = record.args[record.argCount++];
+    arg.type = LogArg::TEXT;
+    arg.text.offset = record.textUsed;
+    arg.text.length = static_cast<uint16_t>(length);
+    std::memcpy(record.text + record.textUsed, text, length);
+    record.textUsed = static_cast<uint16_t>(record.textUsed + length);
+}
+
+static void appendArg(std::string& out, const LogRecord& record, const LogArg& arg) {
+    char buffer[32];
+    int length = 0;
+    switch (arg.type) {
+    case LogArg::INT: length = std::snprintf(buffer, sizeof(buffer), "%" PRId64, arg.i); break;
+    case LogArg::UINT: length = std::snprintf(buffer, sizeof(buffer), "%" PRIu64, arg.u); break;
+    case LogArg::DOUBLE: length = std::snprintf(buffer, sizeof(buffer), "%g", arg.d); break;
+    case LogArg::BOOL: out += arg.u ? "true" : "false"; return;
+    case LogArg::TEXT: out.append(record.text + arg.text.offset, arg.text.length); return;
+    }
+    out.append(buffer, static_cast<size_t>(length));
+}
+
+static void formatRecord(std::string& out, const LogRecord& record) {
+    char prefix[48];
+    std::snprintf(prefix, sizeof(prefix), "[%10.4f] %-5s ", record.timeMicros / 1e6, LEVEL_NAMES[record.level]);
+    out += prefix;
+    size_t nextArg = 0;
+    for (const char* p = record.format; *p; ++p) {
+        if (p[0] == '{' && p[1] == '}' && nextArg < record.argCount) {
+            appendArg(out, record, record.args[nextArg++]);
+            ++p;
+        }
+        else {
+            out += *p;
+        }
+    }
+    out += '\n';
+}
+
+size_t Logger::drain(std::string& out) {
+    size_t count = 0;
+    for (;;) {
+        Slot& slot = slots[dequeuePosition & (LOG_QUEUE_SIZE - 1)];
+        size_t sequence = slot.sequence.load(std::memory_order_acquire);
+        if (sequence != dequeuePosition + 1) break;
+        formatRecord(out, slot.record);
+        slot.sequence.store(dequeuePosition + LOG_QUEUE_SIZE, std::memory_order_release);
+        ++dequeuePosition;
+        ++count;
+    }
+    uint64_t lost = dropped.exchange(0, std::memory_order_relaxed);
+    if (lost > 0) {
+        out += "[log] queue full, dropped " + std::to_string(lost) + " message(s)\n";
+    }
+    return count;
+}
+
+void Logger::run() {
+    std::string buffer;
+    for (;;) {
+        bool stopping = !running.load(std::memory_order_acquire);
+        buffer.clear();
+        size_t count = drain(buffer);
+        if (!buffer.empty()) {
+            std::fwrite(buffer.data(), 1, buffer.size(), stderr);
+            std::fflush(stderr);
+            printed.fetch_add(count, std::memory_order_relaxed);
+        }
+        else if (stopping) {
+            break;
+        }
+        else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    }
+}
+
+void Logger::flush() {
+    uint64_t target = written.load(std::memory_order_relaxed);
+    while (printed.load(std::memory_order_relaxed) < target) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
@@ -0,0 +1,155 @@
+﻿#ifndef LOGGER_HPP
+#define LOGGER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+
+// Mức log. Mức thấp hơn LOG_COMPILE_LEVEL bị xóa hẳn khi biên dịch, kể cả phần tính tham số
+#define LOG_LEVEL_TRACE 0
+#define LOG_LEVEL_DEBUG 1
+#define LOG_LEVEL_INFO  2
+#define LOG_LEVEL_WARN  3
+#define LOG_LEVEL_ERROR 4
+#define LOG_LEVEL_OFF   5
+
+#ifndef LOG_COMPILE_LEVEL
+#ifdef NDEBUG
+#define LOG_COMPILE_LEVEL LOG_LEVEL_INFO
+#else
+#define LOG_COMPILE_LEVEL LOG_LEVEL_DEBUG
+#endif
+#endif
+
+const size_t LOG_MAX_ARGS = 6;
+const size_t LOG_TEXT_SIZE = 128;    // Chỗ chứa bản sao các tham số chuỗi của một bản ghi
+const size_t LOG_QUEUE_SIZE = 4096;  // Số bản ghi, lũy thừa của 2
+
+// Tham số đã chụp lại; chỉ được định dạng thành chữ trên thread ghi log
+struct LogArg {
+    enum Type : uint8_t { INT, UINT, DOUBLE, BOOL, TEXT };
+    struct TextRef { uint16_t offset, length; };
+    Type type;
+    union {
+        int64_t i;
+        uint64_t u;
+        double d;
+        TextRef text;
+    };
+};
+
+struct LogRecord {
+    const char* format; // Phải là chuỗi hằng: được đọc sau khi hàm ghi log đã trả về
+    int64_t timeMicros;
+    uint8_t level;
+    uint8_t argCount;
+    uint16_t textUsed;
+    LogArg args[LOG_MAX_ARGS];
+    char text[LOG_TEXT_SIZE];
+};
+
+// Logger bất đồng bộ: các thread ghi bản ghi vào hàng đợi vòng MPSC không khóa,
+// một thread nền định dạng và in ra stderr. Hàng đợi đầy thì bản ghi bị bỏ và đếm lại,
+// game loop không bao giờ phải chờ. Chuỗi định dạng dùng "{}" cho mỗi tham số.
+class Logger {
+public:
+    static Logger& instance();
+
+    // Lọc thêm lúc chạy, trên mức đã chọn khi biên dịch
+    void setLevel(int level) { minLevel.store(level, std::memory_order_relaxed); }
+    bool isEnabled(int level) const { return level >= minLevel.load(std::memory_order_relaxed); }
+    // Chờ thread nền in hết những gì đã ghi
+    void flush();
+
+    template <typename... Args>
+    void write(int level, const char* format, const Args&... args) {
+        static_assert(sizeof...(Args) <= LOG_MAX_ARGS, "too many log arguments");
+        if (!isEnabled(level)) return;
+        size_t position;
+        LogRecord* record = beginRecord(position);
+        if (!record) return;
+        record->format = format;
+        record->level = static_cast<uint8_t>(level);
+        record->argCount = 0;
+        record->textUsed = 0;
+        int expand[] = { 0, (capture(*record, args), 0)... };
+        (void)expand;
+        commitRecord(position);
+    }
+
+private:
+    Logger();
+    ~Logger();
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    struct Slot {
+        std::atomic<size_t> sequence;
+        LogRecord record;
+    };
+
+    LogRecord* beginRecord(size_t& position);
+    void commitRecord(size_t position);
+    size_t drain(std::string& out);
+    void run();
+
+    static void captureInt(LogRecord& record, int64_t value);
+    static void captureUInt(LogRecord& record, uint64_t value);
+    static void captureText(LogRecord& record, const char* text, size_t length);
+    static void capture(LogRecord& record, bool value);
+    static void capture(LogRecord& record, char value) { captureText(record, &value, 1); }
+    static void capture(LogRecord& record, int value) { captureInt(record, value); }
+    static void capture(LogRecord& record, long value) { captureInt(record, value); }
+    static void capture(LogRecord& record, long long value) { captureInt(record, value); }
+    static void capture(LogRecord& record, unsigned value) { captureUInt(record, value); }
+    static void capture(LogRecord& record, unsigned long value) { captureUInt(record, value); }
+    static void capture(LogRecord& record, unsigned long long value) { captureUInt(record, value); }
+    static void capture(LogRecord& record, double value);
+    static void capture(LogRecord& record, float value) { capture(record, static_cast<double>(value)); }
+    static void capture(LogRecord& record, const char* value) { captureText(record, value ? value : "(null)", value ? std::strlen(value) : 6); }
+    static void capture(LogRecord& record, const unsigned char* value) { capture(record, reinterpret_cast<const char*>(value)); }
+    static void capture(LogRecord& record, const std::string& value) { captureText(record, value.data(), value.size()); }
+
+    Slot* slots;
+    alignas(64) std::atomic<size_t> enqueuePosition;
+    alignas(64) size_t dequeuePosition;
+    std::atomic<uint64_t> dropped;
+    std::atomic<uint64_t> written;
+    std::atomic<uint64_t> printed;
+    std::atomic<int> minLevel;
+    std::atomic<bool> running;
+    std::thread worker;
+};
+
+#define LOG_WRITE(level, ...) Logger::instance().write(level, __VA_ARGS__)
+
+#if LOG_COMPILE_LEVEL <= LOG_LEVEL_TRACE
+#define LOG_TRACE(...) LOG_WRITE(LOG_LEVEL_TRACE, __VA_ARGS__)
+#else
+#define LOG_TRACE(...) ((void)0)
+#endif
+#if LOG_COMPILE_LEVEL <= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) LOG_WRITE(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) ((void)0)
+#endif
+#if LOG_COMPILE_LEVEL <= LOG_LEVEL_INFO
+#define LOG_INFO(...) LOG_WRITE(LOG_LEVEL_INFO, __VA_ARGS__)
+#else
+#define LOG_INFO(...) ((void)0)
+#endif
+#if LOG_COMPILE_LEVEL <= LOG_LEVEL_WARN
+#define LOG_WARN(...) LOG_WRITE(LOG_LEVEL_WARN, __VA_ARGS__)
+#else
+#define LOG_WARN(...) ((void)0)
+#endif
+#if LOG_COMPILE_LEVEL <= LOG_LEVEL_ERROR
+#define LOG_ERROR(...) LOG_WRITE(LOG_LEVEL_ERROR, __VA_ARGS__)
+#else
+#define LOG_ERROR(...) ((void)0)
+#endif
+
+#endif // LOGGER_HPP
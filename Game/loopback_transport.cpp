@@ -0,0 +1,46 @@
+﻿#include "loopback_transport.hpp"
+#include <cstring>
+
+LoopbackTransport::LoopbackTransport(const LinkConditions& conditions, uint64_t seed)
+    : conditions(conditions), rng(seed) {
+    inFlight[0].reserve(256);
+    inFlight[1].reserve(256);
+}
+
+void LoopbackTransport::send(int from, const uint8_t* data, size_t size, double nowMs) {
+    ++sent;
+    // Tung cả hai lần dù gói bị bỏ để chuỗi ngẫu nhiên không phụ thuộc vào kết quả
+    float lossRoll = rng.nextBelow(10000) / 100.0f;
+    double jitter = conditions.jitterMs * (rng.next() / 4294967296.0);
+    if (size > MAX_LOOPBACK_PACKET_SIZE || lossRoll < conditions.lossPercent) {
+        ++dropped;
+        return;
+    }
+
+    std::vector<Packet>& queue = inFlight[1 - from];
+    queue.emplace_back();
+    Packet& packet = queue.back();
+    packet.deliverAt = nowMs + conditions.latencyMs + jitter;
+    packet.sequence = sent;
+    packet.size = size;
+    std::memcpy(packet.data, data, size);
+}
+
+bool LoopbackTransport::receive(int to, double nowMs, std::vector<uint8_t>& out) {
+    std::vector<Packet>& queue = inFlight[to];
+    size_t best = queue.size();
+    for (size_t i = 0; i < queue.size(); ++i) {
+        const Packet& packet = queue[i];
+        if (packet.deliverAt > nowMs) continue;
+        if (best == queue.size() || packet.deliverAt < queue[best].deliverAt ||
+            (packet.deliverAt == queue[best].deliverAt && packet.sequence < queue[best].sequence)) {
+            best = i;
+        }
+    }
+    if (best == queue.size()) return false;
+
+    out.assign(queue[best].data, queue[best].data + queue[best].size);
+    queue[best] = queue.back();
+    queue.pop_back();
+    return true;
+}
@@ -0,0 +1,49 @@
+﻿#ifndef LOOPBACK_TRANSPORT_HPP
+#define LOOPBACK_TRANSPORT_HPP
+
+#include "rng.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+const size_t MAX_LOOPBACK_PACKET_SIZE = 512;
+
+// Điều kiện đường truyền giả lập
+struct LinkConditions {
+    double latencyMs = 0.0; // Độ trễ một chiều
+    double jitterMs = 0.0;  // Mỗi gói trễ thêm ngẫu nhiên trong [0, jitterMs), nên gói có thể đến sai thứ tự
+    float lossPercent = 0.0f;
+};
+
+// Đường truyền giữa hai đầu 0 và 1 trong cùng một process, hành xử như UDP: gói có thể bị mất,
+// đến muộn hoặc sai thứ tự theo LinkConditions. Thời gian do bên gọi truyền vào nên một lần thử
+// với cùng seed luôn cho cùng kết quả và chạy nhanh hơn thời gian thực được.
+// Không an toàn khi dùng từ nhiều thread.
+class LoopbackTransport {
+public:
+    LoopbackTransport(const LinkConditions& conditions, uint64_t seed);
+
+    // Gửi gói từ đầu from sang đầu kia lúc nowMs. Gói lớn hơn MAX_LOOPBACK_PACKET_SIZE bị bỏ
+    void send(int from, const uint8_t* data, size_t size, double nowMs);
+    // Lấy gói đến đầu to sớm nhất đã tới nơi tính đến nowMs; false nếu chưa có gói nào
+    bool receive(int to, double nowMs, std::vector<uint8_t>& out);
+
+    uint64_t sentCount() const { return sent; }
+    uint64_t droppedCount() const { return dropped; }
+
+private:
+    struct Packet {
+        double deliverAt;
+        uint64_t sequence; // Gói đến cùng lúc thì giữ thứ tự gửi
+        size_t size;
+        uint8_t data[MAX_LOOPBACK_PACKET_SIZE];
+    };
+
+    LinkConditions conditions;
+    MatchRng rng;
+    std::vector<Packet> inFlight[2]; // Theo đầu nhận
+    uint64_t sent = 0;
+    uint64_t dropped = 0;
+};
+
+#endif // LOOPBACK_TRANSPORT_HPP
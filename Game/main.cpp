@@ -1,5 +1,4 @@
-﻿#include <iostream>
-#include <vector>
+﻿#include <vector>
 #include <ctime>
 #include <algorithm> 
 #include <cstdlib>
@@ -12,11 +11,24 @@
 #include "stb_image.h"
 #include "character.hpp"
 #include "texture_manager.hpp"
+#include "asset_manifest.hpp"
+#include "match_simulation.hpp"
+#include "match_renderer.hpp"
+#include "sprite_batch.hpp"
+#include "logger.hpp"
+#include "arena.hpp"
+#include "alloc_counter.hpp"
+#include "profiler.hpp"
+#include "perf_hud.hpp"
+#include "gpu_timer.hpp"
+#include "replay.hpp"
 
 const int WIDTH = 1500;
 const int HEIGHT = 900;
-
-const float CHARACTER_SCALE = 1.0f;
+const size_t FRAME_ARENA_SIZE = 64 * 1024; // Bộ nhớ tạm của một frame, reset đầu mỗi vòng lặp
+const int ALLOC_WARMUP_FRAMES = 120;       // Số frame đầu trận được phép cấp phát (ImGui, SpriteBatch lớn dần)
+const char* PROFILE_TRACE_PATH = "profile_trace.json"; // F9 bật/tắt ghi profile, tắt thì xuất ra đây
+const char* LAST_REPLAY_PATH = "last_match.lqr";      // Replay của trận PvP gần nhất, ghi khi trận kết thúc
 
 const char* vertexShaderSource = R"(
     #version 330 core
@@ -39,7 +51,27 @@ const char* fragmentShaderSource = R"(
     }
 )";
 
-GLuint CreateShaderProgram() {
+// Đọc trạng thái phím của một người chơi thành bitmask cho MatchSimulation
+uint8_t ReadPlayerInput(ImGuiKey left, ImGuiKey right, ImGuiKey up, ImGuiKey down,
+    ImGuiKey attack, ImGuiKey skill, ImGuiKey dodge) {
+    uint8_t buttons = 0;
+    if (ImGui::IsKeyDown(left)) buttons |= PlayerInput::LEFT;
+    if (ImGui::IsKeyDown(right)) buttons |= PlayerInput::RIGHT;
+    if (ImGui::IsKeyDown(up)) buttons |= PlayerInput::UP;
+    if (ImGui::IsKeyDown(down)) buttons |= PlayerInput::DOWN;
+    if (ImGui::IsKeyDown(attack)) buttons |= PlayerInput::ATTACK;
+    if (ImGui::IsKeyDown(skill)) buttons |= PlayerInput::SKILL;
+    if (ImGui::IsKeyDown(dodge)) buttons |= PlayerInput::DODGE;
+    return buttons;
+}
+
+const char* BuffTypeName(int type) {
+    return (type == BUFF_HEAL) ? "HEAL" :
+        (type == BUFF_DAMAGE_BOOST) ? "DAMAGE_BOOST" :
+        (type == BUFF_SHIELD) ? "SHIELD" : "SPEED";
+}
+
+GLuint CreateShaderProgram(const char* vertexShaderSource, const char* fragmentShaderSource) {
     GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
     glShaderSource(vertexShader, 1, &vertexShaderSource, nullptr);
     glCompileShader(vertexShader);
@@ -48,7 +80,7 @@ GLuint CreateShaderProgram() {
     if (!success) {
         char infoLog[512];
         glGetShaderInfoLog(vertexShader, 512, nullptr, infoLog);
-        std::cerr << "Vertex shader compilation failed: " << infoLog << "\n";
+        LOG_ERROR("Vertex shader compilation failed: {}", infoLog);
     }
 
     GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
@@ -58,7 +90,7 @@ GLuint CreateShaderProgram() {
     if (!success) {
         char infoLog[512];
         glGetShaderInfoLog(fragmentShader, 512, nullptr, infoLog);
-        std::cerr << "Fragment shader compilation failed: " << infoLog << "\n";
+        LOG_ERROR("Fragment shader compilation failed: {}", infoLog);
     }
 
     GLuint shaderProgram = glCreateProgram();
@@ -69,7 +101,7 @@ GLuint CreateShaderProgram() {
     if (!success) {
         char infoLog[512];
         glGetProgramInfoLog(shaderProgram, 512, nullptr, infoLog);
-        std::cerr << "Shader program linking failed: " << infoLog << "\n";
+        LOG_ERROR("Shader program linking failed: {}", infoLog);
     }
 
     glDeleteShader(vertexShader);
@@ -78,10 +110,11 @@ GLuint CreateShaderProgram() {
 }
 
 int main() {
-    std::cout << "Starting main\n";
+    LOG_INFO("Starting main");
+    Profiler::setThreadName("Main");
 
     if (!glfwInit()) {
-        std::cerr << "Failed to initialize GLFW\n";
+        LOG_ERROR("Failed to initialize GLFW");
         return -1;
     }
 
@@ -92,7 +125,7 @@ int main() {
 
     GLFWwindow* window = glfwCreateWindow(WIDTH, HEIGHT, "LQHN - Game Doi Khang 1v1", nullptr, nullptr);
     if (!window) {
-        std::cerr << "Failed to create GLFW window\n";
+        LOG_ERROR("Failed to create GLFW window");
         glfwTerminate();
         return -1;
     }
@@ -101,7 +134,7 @@ int main() {
 
     glewExperimental = GL_TRUE;
     if (glewInit() != GLEW_OK) {
-        std::cerr << "Failed to initialize GLEW\n";
+        LOG_ERROR("Failed to initialize GLEW");
         glfwDestroyWindow(window);
         glfwTerminate();
         return -1;
@@ -109,9 +142,7 @@ int main() {
 
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    std::cout << "OpenGL version: " << glGetString(GL_VERSION) << "\n";
-
-    srand(static_cast<unsigned int>(time(nullptr)));
+    LOG_INFO("OpenGL version: {}", glGetString(GL_VERSION));
 
     IMGUI_CHECKVERSION();
     ImGui::CreateContext();
@@ -120,7 +151,12 @@ int main() {
     ImGui_ImplGlfw_InitForOpenGL(window, true);
     ImGui_ImplOpenGL3_Init("#version 330");
 
-    GLuint shaderProgram = CreateShaderProgram();
+    GLuint shaderProgram = CreateShaderProgram(vertexShaderSource, fragmentShaderSource);
+    GLuint spriteShaderProgram = CreateShaderProgram(SpriteBatch::vertexShaderSource, SpriteBatch::fragmentShaderSource);
+    SpriteBatch spriteBatch;
+    spriteBatch.init(spriteShaderProgram);
+    GpuTimer gpuTimer;
+    gpuTimer.init();
 
     GLuint VAO, VBO, EBO;
     glGenVertexArrays(1, &VAO);
@@ -151,52 +187,163 @@ int main() {
 
     glBindVertexArray(0);
 
+    // Ưu tiên asset pack đã xếp sẵn (tạo bằng asset_packer); nếu không có thì giải mã ảnh gốc
+    // trên thread nền, menu hiện ngay với texture tạm và được upload dần mỗi frame
     TextureManager textureManager;
-    textureManager.loadTexture("menu_background", "../x64/Debug/bg.jpg");
-    textureManager.loadTexture("game_background", "../x64/Debug/fbg.jpg");
-    textureManager.loadTexture("arrow", "../x64/Debug/arrow.PNG");
-
-    if (textureManager.getTexture("menu_background") == 0) {
-        std::cerr << "Warning: Could not load menu background texture. Falling back to default background.\n";
-    }
-    if (textureManager.getTexture("game_background") == 0) {
-        std::cerr << "Warning: Could not load game background texture. Falling back to default background.\n";
-    }
-    if (textureManager.getTexture("arrow") == 0) {
-        std::cerr << "Warning: Could not load arrow texture. Falling back to default rectangle.\n";
+    if (!textureManager.loadAssetPack(ASSET_PACK_PATH)) {
+        for (const AssetEntry& entry : BACKGROUND_ASSETS) {
+            textureManager.loadTextureAsync(entry.key, entry.path);
+        }
+        std::vector<std::pair<std::string, std::string>> sprites;
+        for (const AssetEntry& entry : SPRITE_ASSETS) {
+            sprites.emplace_back(entry.key, entry.path);
+        }
+        textureManager.loadAtlasAsync(sprites, SPRITE_ATLAS_SIZE);
     }
 
+    const TextureId menuBackground = textureManager.getTextureId("menu_background");
+    const TextureId gameBackground = textureManager.getTextureId("game_background");
+
     bool battleStarted = false;
     int gameMode = 0;
     bool selectingCharacter = false;
     int p1Character = -1, p2Character = -1;
     bool p1Chosen = false, p2Chosen = false;
 
-    Character* p1 = nullptr;
-    Character* p2 = nullptr;
-    std::vector<BuffItem*> buffs;
-    float lastSpawnTime = 0.0f;
-    const float SPAWN_INTERVAL = 15.0f;
-
-    float gameEndTime = 0.0f;
-    bool gameEnded = false;
+    MatchSimulation sim;
+    MatchRenderer renderer(textureManager, spriteBatch);
     const float GAME_END_DELAY = 1.0f;
-    std::string p1BuffMessage = "";
-    std::string p2BuffMessage = "";
-    float p1BuffMessageTime = 0.0f;
-    float p2BuffMessageTime = 0.0f;
     const float BUFF_MESSAGE_DURATION = 3.0f;
-    float lastCollisionDamageTime = 0.0f;
-    const float COLLISION_DAMAGE_INTERVAL = 1.0f;
-    const float COLLISION_DAMAGE = 10.0f;
+    const double MAX_FRAME_TIME = 0.25;
+    double lastFrameTime = glfwGetTime();
+    double accumulator = 0.0;
 
     bool showGuide = false;
+    Arena frameArena(FRAME_ARENA_SIZE);
+    int steadyFrames = 0;
+    PerfHud perfHud;
+    perfHud.setGpuStatus(gpuTimer.isSupported(), gpuTimer.isEmulated());
+
+    Replay replay;
+    ReplayPlayer replayPlayer;
+    bool recording = false;
+    bool replaying = false;
+    float replaySpeed = 1.0f; // 0 = không giới hạn
+
+    auto stepSimulation = [&](const MatchInput& input) {
+        int64_t tickStart = Profiler::nowNanos();
+        sim.step(input);
+        perfHud.addTick((Profiler::nowNanos() - tickStart) / 1e6f);
+    };
 
     while (!glfwWindowShouldClose(window)) {
-        glfwPollEvents();
+        PROFILE_ZONE("Frame");
+        frameArena.reset();
+        AllocationScope frameAllocations;
+
+        gpuTimer.beginFrame();
+        for (int pass = 0; pass < GPU_PASS_COUNT; ++pass) {
+            float gpuMs;
+            if (gpuTimer.newResult(static_cast<GpuPass>(pass), gpuMs)) {
+                perfHud.addGpuPass(static_cast<GpuPass>(pass), gpuMs);
+                Profiler::instance().recordCounter(GpuTimer::passName(static_cast<GpuPass>(pass)), gpuMs);
+            }
+        }
+
+        {
+            PROFILE_ZONE("glfwPollEvents");
+            glfwPollEvents();
+        }
         ImGui_ImplOpenGL3_NewFrame();
         ImGui_ImplGlfw_NewFrame();
         ImGui::NewFrame();
+        textureManager.processUploads(frameArena);
+
+        if (ImGui::IsKeyPressed(ImGuiKey_F3, false)) {
+            perfHud.toggle();
+        }
+        if (ImGui::IsKeyPressed(ImGuiKey_F9, false)) {
+            Profiler& profiler = Profiler::instance();
+            if (!profiler.isEnabled()) {
+                profiler.clear();
+                profiler.setEnabled(true);
+                LOG_INFO("Profiler started, press F9 again to stop");
+            }
+            else {
+                profiler.setEnabled(false);
+                if (profiler.writeChromeTrace(PROFILE_TRACE_PATH)) {
+                    LOG_INFO("Wrote {} profile zones to {} ({} dropped)", profiler.eventCount(), PROFILE_TRACE_PATH, profiler.droppedCount());
+                }
+                else {
+                    LOG_ERROR("Could not write profile trace to {}", PROFILE_TRACE_PATH);
+                }
+                // Xuất JSON có cấp phát, không tính là frame lỗi
+                steadyFrames = 0;
+            }
+        }
+
+        double frameTime = glfwGetTime();
+        float frameMs = static_cast<float>((frameTime - lastFrameTime) * 1000.0);
+        double frameDelta = std::min(frameTime - lastFrameTime, MAX_FRAME_TIME);
+        lastFrameTime = frameTime;
+
+        // Chạy đủ số tick cố định cho thời gian thực đã trôi qua, phần dư dùng để nội suy khi vẽ
+        float alpha = 0.0f;
+        if (battleStarted && sim.hasPlayers() && replaying) {
+            // Phím 1-4: tốc độ 1x, 2x, 4x, không giới hạn
+            if (ImGui::IsKeyPressed(ImGuiKey_1, false)) replaySpeed = 1.0f;
+            if (ImGui::IsKeyPressed(ImGuiKey_2, false)) replaySpeed = 2.0f;
+            if (ImGui::IsKeyPressed(ImGuiKey_3, false)) replaySpeed = 4.0f;
+            if (ImGui::IsKeyPressed(ImGuiKey_4, false)) replaySpeed = 0.0f;
+            int due = replayPlayer.ticksDue(frameDelta, replaySpeed);
+            for (int i = 0; i < due; ++i) {
+                stepSimulation(replayPlayer.nextInput());
+            }
+            alpha = replayPlayer.alpha();
+        }
+        else if (battleStarted && sim.hasPlayers()) {
+            accumulator += frameDelta;
+            if (!sim.state.gameEnded) {
+                if (ImGui::IsKeyPressed(ImGuiKey_E)) {
+                    LOG_DEBUG("P1 ({}) pressed attack key E", p1Character == 0 ? "XaThu" : "DauSi");
+                }
+                if (ImGui::IsKeyPressed(ImGuiKey_Space)) {
+                    LOG_DEBUG("P2 ({}) pressed attack key Space", p2Character == 0 ? "XaThu" : "DauSi");
+                }
+            }
+            MatchInput input;
+            input.buttons[0] = ReadPlayerInput(ImGuiKey_A, ImGuiKey_D, ImGuiKey_W, ImGuiKey_S,
+                ImGuiKey_E, ImGuiKey_Q, ImGuiKey_Q);
+            input.buttons[1] = ReadPlayerInput(ImGuiKey_LeftArrow, ImGuiKey_RightArrow, ImGuiKey_UpArrow, ImGuiKey_DownArrow,
+                ImGuiKey_Space, ImGuiKey_Q, ImGuiKey_Enter);
+            bool replayFinished = false;
+            while (accumulator >= TICK_DT) {
+                bool recordTick = recording && sim.isRunning();
+                if (recordTick) replay.record(input);
+                stepSimulation(input);
+                // Chốt kết quả ngay tick kết thúc trận, các tick còn lại của frame vẫn tăng state.tick
+                if (recordTick && replay.finishIfEnded(sim)) {
+                    recording = false;
+                    replayFinished = true;
+                }
+                accumulator -= TICK_DT;
+            }
+            alpha = static_cast<float>(accumulator / TICK_DT);
+
+            if (replayFinished) {
+                if (saveReplay(LAST_REPLAY_PATH, replay)) {
+                    LOG_INFO("Saved replay of {} ticks to {}", replay.tickCount, LAST_REPLAY_PATH);
+                }
+                else {
+                    LOG_ERROR("Could not write replay to {}", LAST_REPLAY_PATH);
+                }
+            }
+        }
+        else {
+            accumulator = 0.0;
+        }
+        bool hasPlayers = sim.hasPlayers();
+        bool gameEnded = sim.state.gameEnded;
 
         int display_w, display_h;
         glfwGetFramebufferSize(window, &display_w, &display_h);
@@ -205,10 +352,12 @@ int main() {
         glClearColor(0.1f, 0.1f, 1.0f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        float currentTime = static_cast<float>(glfwGetTime());
+        float currentTime = sim.time();
         if (!battleStarted) {
-            GLuint menuTex = textureManager.getTexture("menu_background");
+            GLuint menuTex = textureManager.getTexture(menuBackground);
             if (menuTex != 0) {
+                PROFILE_ZONE("Background");
+                gpuTimer.begin(GPU_PASS_BACKGROUND);
                 glUseProgram(shaderProgram);
                 glBindVertexArray(VAO);
                 glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
@@ -218,15 +367,18 @@ int main() {
                 glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
                 glBindVertexArray(0);
                 glUseProgram(0);
+                gpuTimer.end(GPU_PASS_BACKGROUND);
             }
             else {
-                std::cerr << "Warning: Could not load menu background texture during rendering.\n";
+                LOG_WARN("Could not load menu background texture during rendering");
             }
         }
 
         if (battleStarted && !gameEnded) {
-            GLuint gameTex = textureManager.getTexture("game_background");
+            GLuint gameTex = textureManager.getTexture(gameBackground);
             if (gameTex != 0) {
+                PROFILE_ZONE("Background");
+                gpuTimer.begin(GPU_PASS_BACKGROUND);
                 glUseProgram(shaderProgram);
                 glBindVertexArray(VAO);
                 glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
@@ -236,27 +388,29 @@ int main() {
                 glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
                 glBindVertexArray(0);
                 glUseProgram(0);
+                gpuTimer.end(GPU_PASS_BACKGROUND);
             }
             else {
-                std::cerr << "Warning: Could not load game background texture during rendering.\n";
+                LOG_WARN("Could not load game background texture during rendering");
             }
 
-            if (p1 && !p1->isDead) {
-                float maxHealth = (p1Character == 1) ? 150.0f : 120.0f;
-                float healthPercent = p1->health / maxHealth;
+            if (hasPlayers && !sim.health(0).isDead) {
+                const Health& health = sim.health(0);
+                float maxHealth = health.maxHealth;
+                float healthPercent = health.health / maxHealth;
                 ImGui::GetForegroundDrawList()->AddRectFilled(
                     ImVec2(10, 10), ImVec2(10 + 200 * healthPercent, 30),
                     ImColor(1.0f, 0.0f, 0.0f, 1.0f));
                 ImGui::GetForegroundDrawList()->AddRect(
                     ImVec2(10, 10), ImVec2(210, 30), ImColor(1.0f, 1.0f, 1.0f, 1.0f));
                 char healthText[32];
-                snprintf(healthText, sizeof(healthText), "P1: %.1f/%.1f", p1->health, maxHealth);
+                snprintf(healthText, sizeof(healthText), "P1: %.1f/%.1f", health.health, maxHealth);
                 ImGui::GetForegroundDrawList()->AddText(ImVec2(10, 40), ImColor(1.0f, 1.0f, 1.0f, 1.0f), healthText);
 
                 // Thanh tụ lực cho Player 1
-                XaThu* p1XaThu = dynamic_cast<XaThu*>(p1);
-                if (p1XaThu) {
-                    float chargePercent = p1XaThu->chargeTime / 5.0f * 100.0f;
+                const Fighter& fighter = sim.fighter(0);
+                if (fighter.type == XA_THU) {
+                    float chargePercent = fighter.chargeTime / 5.0f * 100.0f;
                     ImGui::GetForegroundDrawList()->AddRectFilled(
                         ImVec2(10, 50), ImVec2(10 + 200 * (chargePercent / 100.0f), 70),
                         ImColor(0.0f, 1.0f, 0.0f, 1.0f));
@@ -267,22 +421,23 @@ int main() {
                     ImGui::GetForegroundDrawList()->AddText(ImVec2(10, 80), ImColor(1.0f, 1.0f, 1.0f, 1.0f), chargeText);
                 }
             }
-            if (p2 && !p2->isDead) {
-                float maxHealth = (p2Character == 1) ? 150.0f : 120.0f;
-                float healthPercent = p2->health / maxHealth;
+            if (hasPlayers && !sim.health(1).isDead) {
+                const Health& health = sim.health(1);
+                float maxHealth = health.maxHealth;
+                float healthPercent = health.health / maxHealth;
                 ImGui::GetForegroundDrawList()->AddRectFilled(
                     ImVec2(WIDTH - 210, 10), ImVec2(WIDTH - 210 + 200 * healthPercent, 30),
                     ImColor(0.0f, 1.0f, 1.0f, 1.0f));
                 ImGui::GetForegroundDrawList()->AddRect(
                     ImVec2(WIDTH - 210, 10), ImVec2(WIDTH - 10, 30), ImColor(1.0f, 1.0f, 1.0f, 1.0f));
                 char healthText[32];
-                snprintf(healthText, sizeof(healthText), "P2: %.1f/%.1f", p2->health, maxHealth);
+                snprintf(healthText, sizeof(healthText), "P2: %.1f/%.1f", health.health, maxHealth);
                 ImGui::GetForegroundDrawList()->AddText(ImVec2(WIDTH - 210, 40), ImColor(1.0f, 1.0f, 1.0f, 1.0f), healthText);
 
                 // Thanh tụ lực cho Player 2
-                XaThu* p2XaThu = dynamic_cast<XaThu*>(p2);
-                if (p2XaThu) {
-                    float chargePercent = p2XaThu->chargeTime / 5.0f * 100.0f;
+                const Fighter& fighter = sim.fighter(1);
+                if (fighter.type == XA_THU) {
+                    float chargePercent = fighter.chargeTime / 5.0f * 100.0f;
                     ImGui::GetForegroundDrawList()->AddRectFilled(
                         ImVec2(WIDTH - 210, 50), ImVec2(WIDTH - 210 + 200 * (chargePercent / 100.0f), 70),
                         ImColor(0.0f, 1.0f, 0.0f, 1.0f));
@@ -294,14 +449,11 @@ int main() {
                 }
             }
 
-            if (p1 && !p1->isDead && !p1->damageNumbers.empty()) {
-                p1->updateDamageNumbers(currentTime);
-                p1->drawDamageNumbers();
-            }
-            if (p2 && !p2->isDead && !p2->damageNumbers.empty()) {
-                p2->updateDamageNumbers(currentTime);
-                p2->drawDamageNumbers();
-            }
+            gpuTimer.begin(GPU_PASS_WORLD);
+            spriteBatch.begin(static_cast<float>(WIDTH), static_cast<float>(HEIGHT));
+            renderer.draw(sim, alpha);
+            spriteBatch.end();
+            gpuTimer.end(GPU_PASS_WORLD);
         }
 
         if (!selectingCharacter && !battleStarted && !showGuide) {
@@ -323,13 +475,7 @@ int main() {
                 selectingCharacter = true;
                 p1Character = p2Character = -1;
                 p1Chosen = p2Chosen = false;
-                p1 = nullptr;
-                p2 = nullptr;
-                for (BuffItem* b : buffs) delete b;
-                buffs.clear();
-                gameEnded = false;
-                p1BuffMessage = "";
-                p2BuffMessage = "";
+                sim.reset();
             }
 
             ImGui::SetCursorPosX((WIDTH - 200) * 0.5f);
@@ -338,6 +484,24 @@ int main() {
                 showGuide = true;
             }
 
+            ImGui::SetCursorPosX((WIDTH - 200) * 0.5f);
+            ImGui::SetCursorPosY(HEIGHT * 0.7f);
+            if (ImGui::Button("Xem lai tran truoc", ImVec2(200, 50))) {
+                if (loadReplay(LAST_REPLAY_PATH, replay)) {
+                    renderer.loadCharacterTextures(replay.p1Type);
+                    renderer.loadCharacterTextures(replay.p2Type);
+                    replayPlayer.start(sim, replay);
+                    renderer.beginMatch(sim);
+                    battleStarted = true;
+                    replaying = true;
+                    recording = false;
+                    replaySpeed = 1.0f;
+                }
+                else {
+                    LOG_WARN("Could not load replay {}", LAST_REPLAY_PATH);
+                }
+            }
+
             ImGui::End();
         }
 
@@ -391,14 +555,14 @@ int main() {
                     if (ImGui::Button("Xa Thu##P1", ImVec2(200, 50))) {
                         p1Character = 0;
                         p1Chosen = true;
-                        p1 = new XaThu(150.0f, HEIGHT - 50.0f, ImVec4(1.0f, 0.0f, 0.0f, 1.0f), textureManager);
+                        renderer.loadCharacterTextures(XA_THU);
                     }
                     ImGui::SetCursorPosX((WIDTH - 200) * 0.5f);
                     ImGui::SetCursorPosY(HEIGHT * 0.5f);
                     if (ImGui::Button("Dau Si##P1", ImVec2(200, 50))) {
                         p1Character = 1;
                         p1Chosen = true;
-                        p1 = new DauSi(150.0f, HEIGHT - 50.0f, ImVec4(1.0f, 0.0f, 0.0f, 1.0f), textureManager);
+                        renderer.loadCharacterTextures(DAU_SI);
                     }
                 }
                 else if (!p2Chosen) {
@@ -411,14 +575,14 @@ int main() {
                     if (ImGui::Button("Xa Thu##P2", ImVec2(200, 50))) {
                         p2Character = 0;
                         p2Chosen = true;
-                        p2 = new XaThu(1350.0f, HEIGHT - 50.0f, ImVec4(0.0f, 1.0f, 1.0f, 1.0f), textureManager);
+                        renderer.loadCharacterTextures(XA_THU);
                     }
                     ImGui::SetCursorPosX((WIDTH - 200) * 0.5f);
                     ImGui::SetCursorPosY(HEIGHT * 0.5f);
                     if (ImGui::Button("Dau Si##P2", ImVec2(200, 50))) {
                         p2Character = 1;
                         p2Chosen = true;
-                        p2 = new DauSi(1350.0f, HEIGHT - 50.0f, ImVec4(0.0f, 1.0f, 1.0f, 1.0f), textureManager);
+                        renderer.loadCharacterTextures(DAU_SI);
                     }
                 }
                 else {
@@ -431,9 +595,13 @@ int main() {
                     if (ImGui::Button("Bat dau tran dau", ImVec2(200, 50))) {
                         selectingCharacter = false;
                         battleStarted = true;
-                        lastSpawnTime = static_cast<float>(glfwGetTime());
-                        lastCollisionDamageTime = lastSpawnTime;
-                        gameEnded = false;
+                        sim.start(static_cast<CharacterType>(p1Character), static_cast<CharacterType>(p2Character),
+                            static_cast<uint32_t>(time(nullptr)));
+                        renderer.beginMatch(sim);
+                        accumulator = 0.0;
+                        replay.begin(sim);
+                        recording = true;
+                        replaying = false;
                     }
                 }
             }
@@ -441,126 +609,30 @@ int main() {
             ImGui::End();
         }
 
-        if (battleStarted && p1 && p2 && !gameEnded) {
-            if (!p1->isDead) {
-                p1->move(ImGuiKey_A, ImGuiKey_D, ImGuiKey_W, ImGuiKey_S);
-                p1->dodge(ImGuiKey_Q);
-                if (p1Character == 0) { // XaThu
-                    if (ImGui::IsKeyPressed(ImGuiKey_E)) {
-                        std::cerr << "P1 (XaThu) pressed attack key E\n";
-                    }
-                    p1->attack(p2, ImGuiKey_E);
-                }
-                else { // DauSi
-                    if (ImGui::IsKeyPressed(ImGuiKey_E)) {
-                        std::cerr << "P1 (DauSi) pressed attack key E\n";
-                    }
-                    p1->attack(p2, ImGuiKey_E);
-                }
-                p1->useSkill(p2);
-            }
-            if (!p2->isDead) {
-                p2->move(ImGuiKey_LeftArrow, ImGuiKey_RightArrow, ImGuiKey_UpArrow, ImGuiKey_DownArrow);
-                p2->dodge(ImGuiKey_Enter);
-                if (p2Character == 0) { // XaThu
-                    if (ImGui::IsKeyPressed(ImGuiKey_Space)) {
-                        std::cerr << "P2 (XaThu) pressed attack key Space\n";
-                    }
-                    p2->attack(p1, ImGuiKey_Space); // Player 2 bắn mũi tên với phím Space
-                }
-                else { // DauSi
-                    if (ImGui::IsKeyPressed(ImGuiKey_Space)) {
-                        std::cerr << "P2 (DauSi) pressed attack key Space\n";
-                    }
-                    p2->attack(p1, ImGuiKey_Space);
-                }
-                p2->useSkill(p1);
-            }
-
-            if (!p1->isDead) p1->draw();
-            if (!p2->isDead) p2->draw();
-
-            if (currentTime - lastSpawnTime > SPAWN_INTERVAL) {
-                lastSpawnTime = currentTime;
-
-                float randomX = (WIDTH / 3.0f) + (rand() % static_cast<int>(WIDTH / 3.0f));
-                float randomY = (HEIGHT / 3.0f) + (rand() % static_cast<int>(HEIGHT / 3.0f));
-
-                float scaledSize = 50.0f * CHARACTER_SCALE;
-                float LEFT_LIMIT = -100.0f;
-                float RIGHT_LIMIT = 1500.0f - scaledSize + 100.0f;
-                float GRASS_TOP = 300.0f;
-                float GRASS_BOTTOM = 900.0f - scaledSize + 89.0f;
-
-                float spawnX = std::clamp(randomX, LEFT_LIMIT, RIGHT_LIMIT);
-                float spawnY = std::clamp(randomY, GRASS_TOP, GRASS_BOTTOM);
-                BuffItem::BuffType buff = static_cast<BuffItem::BuffType>(rand() % 4);
-                ImVec4 buffColor = (buff == BuffItem::DAMAGE_BOOST) ? ImVec4(1.0f, 0.5f, 0.5f, 1.0f) :
-                    (buff == BuffItem::HEAL) ? ImVec4(0.5f, 1.0f, 0.5f, 1.0f) :
-                    (buff == BuffItem::SHIELD) ? ImVec4(0.5f, 0.5f, 1.0f, 1.0f) :
-                    ImVec4(0.5f, 0.5f, 0.5f, 1.0f);
-                buffs.push_back(new BuffItem(spawnX, spawnY, buffColor, buff));
-            }
-
-            for (auto it = buffs.begin(); it != buffs.end(); ) {
-                BuffItem* b = *it;
-                bool p1Hit = p1 && !p1->isDead && p1->isCollidingWith(b);
-                bool p2Hit = p2 && !p2->isDead && p2->isCollidingWith(b);
-
-                if (p1Hit) {
-                    if (!p1->isDodging) {
-                        b->applyBuff(p1);
-                        std::string buffType = (b->type == BuffItem::HEAL) ? "HEAL" :
-                            (b->type == BuffItem::DAMAGE_BOOST) ? "DAMAGE_BOOST" :
-                            (b->type == BuffItem::SHIELD) ? "SHIELD" : "SPEED";
-                        p1BuffMessage = "Player 1 received " + buffType + " buff!";
-                        p1BuffMessageTime = currentTime;
-                        delete b;
-                        it = buffs.erase(it);
-                        continue;
-                    }
-                }
-                else if (p2Hit) {
-                    if (!p2->isDodging) {
-                        b->applyBuff(p2);
-                        std::string buffType = (b->type == BuffItem::HEAL) ? "HEAL" :
-                            (b->type == BuffItem::DAMAGE_BOOST) ? "DAMAGE_BOOST" :
-                            (b->type == BuffItem::SHIELD) ? "SHIELD" : "SPEED";
-                        p2BuffMessage = "Player 2 received " + buffType + " buff!";
-                        p2BuffMessageTime = currentTime;
-                        delete b;
-                        it = buffs.erase(it);
-                        continue;
-                    }
-                }
-                else {
-                    b->draw();
-                    ++it;
-                }
-            }
-
-            if (!p1BuffMessage.empty() && (currentTime - p1BuffMessageTime < BUFF_MESSAGE_DURATION)) {
+        if (battleStarted && hasPlayers && !gameEnded) {
+            if (sim.state.buffMessageType[0] >= 0 && (currentTime - sim.state.buffMessageTime[0] < BUFF_MESSAGE_DURATION)) {
                 ImGui::SetNextWindowPos(ImVec2(10, 60), ImGuiCond_Always);
                 ImGui::Begin("P1 Buff", nullptr, ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_AlwaysAutoResize);
-                ImGui::Text("%s", p1BuffMessage.c_str());
+                ImGui::Text("Player 1 received %s buff!", BuffTypeName(sim.state.buffMessageType[0]));
                 ImGui::End();
             }
-            if (!p2BuffMessage.empty() && (currentTime - p2BuffMessageTime < BUFF_MESSAGE_DURATION)) {
+            if (sim.state.buffMessageType[1] >= 0 && (currentTime - sim.state.buffMessageTime[1] < BUFF_MESSAGE_DURATION)) {
                 ImGui::SetNextWindowPos(ImVec2(WIDTH - 10, 60), ImGuiCond_Always, ImVec2(1.0f, 0.0f));
                 ImGui::Begin("P2 Buff", nullptr, ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_AlwaysAutoResize);
-                ImGui::Text("%s", p2BuffMessage.c_str());
+                ImGui::Text("Player 2 received %s buff!", BuffTypeName(sim.state.buffMessageType[1]));
                 ImGui::End();
             }
+        }
 
-            if ((p1->health <= 0 || p2->health <= 0) && battleStarted && !gameEnded) {
-                gameEndTime = currentTime;
-                gameEnded = true;
-                if (p1->health <= 0) p1->isDead = true;
-                if (p2->health <= 0) p2->isDead = true;
-            }
+        if (replaying && hasPlayers && !gameEnded) {
+            ImGui::SetNextWindowPos(ImVec2(WIDTH * 0.5f, 10), ImGuiCond_Always, ImVec2(0.5f, 0.0f));
+            ImGui::Begin("Replay", nullptr, ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_AlwaysAutoResize);
+            if (replaySpeed > 0.0f) ImGui::Text("Replay %.0fx  tick %u/%u  (1-4: toc do)", replaySpeed, replayPlayer.currentTick(), replayPlayer.tickCount());
+            else ImGui::Text("Replay max  tick %u/%u  (1-4: toc do)", replayPlayer.currentTick(), replayPlayer.tickCount());
+            ImGui::End();
         }
 
-        if (gameEnded && p1 && p2 && currentTime - gameEndTime > GAME_END_DELAY) {
+        if (gameEnded && hasPlayers && currentTime - sim.state.gameEndTime > GAME_END_DELAY) {
             ImGui::SetNextWindowPos(ImVec2(0, 0), ImGuiCond_Always);
             ImGui::SetNextWindowSize(ImVec2(WIDTH, HEIGHT), ImGuiCond_Always);
             ImGui::Begin("Game Over", nullptr,
@@ -571,12 +643,13 @@ int main() {
             ImGui::SetCursorPosY(HEIGHT * 0.3f);
             ImGui::Text("Ket Qua");
 
-            if (p1->isDead && !p2->isDead) {
+            int winner = sim.winner();
+            if (winner == 2) {
                 ImGui::SetCursorPosX((WIDTH - ImGui::CalcTextSize("Player 2 wins!").x) * 0.5f);
                 ImGui::SetCursorPosY(HEIGHT * 0.4f);
                 ImGui::Text("Player 2 wins!");
             }
-            else if (p2->isDead && !p1->isDead) {
+            else if (winner == 1) {
                 ImGui::SetCursorPosX((WIDTH - ImGui::CalcTextSize("Player 1 wins!").x) * 0.5f);
                 ImGui::SetCursorPosY(HEIGHT * 0.4f);
                 ImGui::Text("Player 1 wins!");
@@ -589,7 +662,7 @@ int main() {
 
             char scoreText[100];
             snprintf(scoreText, sizeof(scoreText), "Final Score - P1 Health: %.1f, P2 Health: %.1f",
-                p1->health, p2->health);
+                sim.health(0).health, sim.health(1).health);
             ImGui::SetCursorPosX((WIDTH - ImGui::CalcTextSize(scoreText).x) * 0.5f);
             ImGui::SetCursorPosY(HEIGHT * 0.5f);
             ImGui::Text("%s", scoreText);
@@ -599,20 +672,46 @@ int main() {
             if (ImGui::Button("Quay lai menu", ImVec2(200, 50))) {
                 battleStarted = false;
                 selectingCharacter = false;
-                delete p1; p1 = nullptr;
-                delete p2; p2 = nullptr;
-                for (BuffItem* b : buffs) delete b;
-                buffs.clear();
-                p1BuffMessage = "";
-                p2BuffMessage = "";
+                replaying = false;
+                sim.reset();
             }
 
             ImGui::End();
         }
 
-        ImGui::Render();
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
-        glfwSwapBuffers(window);
+        perfHud.draw(sim, textureManager);
+
+        {
+            PROFILE_ZONE("ImGui render");
+            ImGui::Render();
+            ImDrawData* drawData = ImGui::GetDrawData();
+            gpuTimer.begin(GPU_PASS_UI);
+            ImGui_ImplOpenGL3_RenderDrawData(drawData);
+            gpuTimer.end(GPU_PASS_UI);
+
+            PerfRenderStats renderStats;
+            renderStats.spriteDrawCalls = spriteBatch.getDrawCallCount();
+            renderStats.sprites = spriteBatch.getSpriteCount();
+            renderStats.imguiVertices = drawData->TotalVtxCount;
+            for (int i = 0; i < drawData->CmdListsCount; ++i) {
+                renderStats.imguiDrawCalls += drawData->CmdLists[i]->CmdBuffer.Size;
+            }
+            perfHud.setRenderStats(renderStats);
+        }
+        {
+            PROFILE_ZONE("glfwSwapBuffers");
+            glfwSwapBuffers(window);
+        }
+
+        // Khi trận đã chạy ổn định, mỗi frame không được cấp phát heap (chỉ đo ở bản Debug)
+        uint64_t allocations = frameAllocations.count();
+        perfHud.addFrame(frameMs, allocations);
+        if (ALLOC_COUNTER_ENABLED) {
+            steadyFrames = (battleStarted && !textureManager.isLoading()) ? steadyFrames + 1 : 0;
+            if (steadyFrames > ALLOC_WARMUP_FRAMES && allocations > 0) {
+                LOG_WARN("Frame made {} heap allocations during a match", allocations);
+            }
+        }
     }
 
     textureManager.clear();
@@ -620,15 +719,14 @@ int main() {
     glDeleteBuffers(1, &VBO);
     glDeleteBuffers(1, &EBO);
     glDeleteProgram(shaderProgram);
+    spriteBatch.shutdown();
+    gpuTimer.shutdown();
+    glDeleteProgram(spriteShaderProgram);
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
     glfwDestroyWindow(window);
     glfwTerminate();
 
-    delete p1;
-    delete p2;
-    for (BuffItem* b : buffs) delete b;
-
     return 0;
 }
\ No newline at end of file
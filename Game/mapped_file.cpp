@@ -0,0 +1,105 @@
+﻿#include "mapped_file.hpp"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile() : mappedData(nullptr), mappedSize(0), fileHandle(INVALID_HANDLE_VALUE), mappingHandle(nullptr) {
+}
+
+bool MappedFile::open(const std::string& path) {
+    close();
+    fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0) {
+        close();
+        return false;
+    }
+    mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mappingHandle) {
+        close();
+        return false;
+    }
+    mappedData = static_cast<const unsigned char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    if (!mappedData) {
+        close();
+        return false;
+    }
+    mappedSize = static_cast<size_t>(fileSize.QuadPart);
+    return true;
+}
+
+void MappedFile::close() {
+    if (mappedData) {
+        UnmapViewOfFile(mappedData);
+    }
+    if (mappingHandle) {
+        CloseHandle(mappingHandle);
+    }
+    if (fileHandle != INVALID_HANDLE_VALUE) {
+        CloseHandle(fileHandle);
+    }
+    mappedData = nullptr;
+    mappedSize = 0;
+    mappingHandle = nullptr;
+    fileHandle = INVALID_HANDLE_VALUE;
+}
+
+#else
+
+MappedFile::MappedFile() : mappedData(nullptr), mappedSize(0), fileDescriptor(-1) {
+}
+
+bool MappedFile::open(const std::string& path) {
+    close();
+    fileDescriptor = ::open(path.c_str(), O_RDONLY);
+    if (fileDescriptor < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fileDescriptor, &info) != 0 || info.st_size == 0) {
+        close();
+        return false;
+    }
+    void* address = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+    if (address == MAP_FAILED) {
+        close();
+        return false;
+    }
+    mappedData = static_cast<const unsigned char*>(address);
+    mappedSize = static_cast<size_t>(info.st_size);
+    // Các texture được đọc tuần tự từ đầu đến cuối file
+    madvise(address, mappedSize, MADV_SEQUENTIAL);
+    return true;
+}
+
+void MappedFile::close() {
+    if (mappedData) {
+        munmap(const_cast<unsigned char*>(mappedData), mappedSize);
+    }
+    if (fileDescriptor >= 0) {
+        ::close(fileDescriptor);
+    }
+    mappedData = nullptr;
+    mappedSize = 0;
+    fileDescriptor = -1;
+}
+
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
@@ -0,0 +1,32 @@
+﻿#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <string>
+
+// File chỉ đọc được map thẳng vào bộ nhớ (mmap trên POSIX, MapViewOfFile trên Windows).
+// Dữ liệu chỉ được nạp từ đĩa khi truy cập tới trang tương ứng.
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+    const unsigned char* data() const { return mappedData; }
+    size_t size() const { return mappedSize; }
+
+private:
+    const unsigned char* mappedData;
+    size_t mappedSize;
+#ifdef _WIN32
+    void* fileHandle;
+    void* mappingHandle;
+#else
+    int fileDescriptor;
+#endif
+};
+
+#endif // MAPPED_FILE_HPP
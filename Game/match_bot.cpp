@@ -0,0 +1,82 @@
+﻿#include "match_bot.hpp"
+#include <cmath>
+
+MatchBot::MatchBot(BotPolicy policy, int playerIndex, uint32_t seed)
+    : policy(policy), playerIndex(playerIndex), rng(seed), held(0), holdTicks(0), chargeTicks(0) {
+}
+
+uint8_t MatchBot::think(const MatchSimulation& sim) {
+    BotView view;
+    if (policy == BOT_SCRIPTED && sim.hasPlayers() && !sim.health(playerIndex).isDead) {
+        const Transform& self = sim.transform(playerIndex);
+        const Transform& target = sim.transform(1 - playerIndex);
+        const Fighter& fighter = sim.fighter(playerIndex);
+        view.active = true;
+        view.type = fighter.type;
+        view.selfX = self.x;
+        view.selfY = self.y;
+        view.targetX = target.x;
+        view.targetY = target.y;
+        view.reach = self.size * CHARACTER_SCALE;
+        view.speed = fighter.speed;
+    }
+    return think(view);
+}
+
+uint8_t MatchBot::think(const BotView& view) {
+    switch (policy) {
+    case BOT_RANDOM:
+        return thinkRandom();
+    case BOT_SCRIPTED:
+        return thinkScripted(view);
+    default:
+        return 0;
+    }
+}
+
+uint8_t MatchBot::thinkRandom() {
+    // Giữ một tổ hợp phím ngẫu nhiên trong vài tick rồi đổi
+    if (holdTicks <= 0) {
+        held = static_cast<uint8_t>(rng.next() & 0x7F);
+        holdTicks = 5 + static_cast<int>(rng.nextBelow(30));
+    }
+    --holdTicks;
+    return held;
+}
+
+uint8_t MatchBot::thinkScripted(const BotView& view) {
+    if (!view.active) return 0;
+
+    uint8_t buttons = 0;
+    float dx = view.targetX - view.selfX;
+    float dy = view.targetY - view.selfY;
+    float reach = view.reach;
+
+    if (view.type == DAU_SI) {
+        // Áp sát rồi bấm đánh liên tục, thỉnh thoảng lao tới bằng skill
+        if (std::fabs(dx) > reach * 0.5f) buttons |= dx > 0 ? PlayerInput::RIGHT : PlayerInput::LEFT;
+        if (std::fabs(dy) > view.speed) buttons |= dy > 0 ? PlayerInput::DOWN : PlayerInput::UP;
+        bool inRange = std::fabs(dx) < reach && std::fabs(dy) < reach;
+        if (inRange && (held & PlayerInput::ATTACK) == 0) buttons |= PlayerInput::ATTACK;
+        if (std::fabs(dx) < reach + 100.0f && rng.nextBelow(60) == 0) buttons |= PlayerInput::SKILL;
+    }
+    else {
+        // Giữ khoảng cách, căn hàng ngang với đối thủ rồi tụ lực và bắn
+        if (std::fabs(dx) < 400.0f) buttons |= dx > 0 ? PlayerInput::LEFT : PlayerInput::RIGHT;
+        if (std::fabs(dy) > view.speed) buttons |= dy > 0 ? PlayerInput::DOWN : PlayerInput::UP;
+        bool aligned = std::fabs(dy) < 30.0f;
+        if (chargeTicks <= 0 && (held & PlayerInput::ATTACK) == 0) {
+            chargeTicks = 10 + static_cast<int>(rng.nextBelow(4 * TICK_RATE));
+        }
+        if (chargeTicks > 0) {
+            --chargeTicks;
+            buttons |= PlayerInput::ATTACK;
+        }
+        if (chargeTicks <= 0 && !aligned) buttons |= PlayerInput::ATTACK;
+        if (aligned && (held & PlayerInput::SKILL) == 0 && rng.nextBelow(30) == 0) buttons |= PlayerInput::SKILL;
+    }
+
+    if ((held & PlayerInput::DODGE) == 0 && rng.nextBelow(240) == 0) buttons |= PlayerInput::DODGE;
+    held = buttons;
+    return buttons;
+}
@@ -0,0 +1,40 @@
+﻿#ifndef MATCH_BOT_HPP
+#define MATCH_BOT_HPP
+
+#include "match_simulation.hpp"
+#include <cstdint>
+
+enum BotPolicy { BOT_IDLE, BOT_RANDOM, BOT_SCRIPTED };
+
+// Những gì bot cần biết về trận, lấy từ MatchSimulation cục bộ hoặc từ snapshot server gửi
+struct BotView {
+    bool active = false; // Trận đang có người chơi và bot còn sống
+    CharacterType type = XA_THU;
+    float selfX = 0.0f, selfY = 0.0f;
+    float targetX = 0.0f, targetY = 0.0f;
+    float reach = 0.0f;  // Cạnh hộp va chạm của bot đã nhân CHARACTER_SCALE
+    float speed = 0.0f;
+};
+
+// Sinh input cho một người chơi, dùng cho chạy trận không giao diện
+class MatchBot {
+public:
+    MatchBot(BotPolicy policy, int playerIndex, uint32_t seed);
+
+    // Trả về bitmask PlayerInput cho tick tiếp theo
+    uint8_t think(const MatchSimulation& sim);
+    uint8_t think(const BotView& view);
+
+private:
+    uint8_t thinkRandom();
+    uint8_t thinkScripted(const BotView& view);
+
+    BotPolicy policy;
+    int playerIndex;
+    MatchRng rng;
+    uint8_t held;
+    int holdTicks;
+    int chargeTicks;
+};
+
+#endif // MATCH_BOT_HPP
@@ -0,0 +1,163 @@
+﻿#include "match_renderer.hpp"
+#include "asset_manifest.hpp"
+#include "imgui.h"
+#include "logger.hpp"
+#include "profiler.hpp"
+#include <cstdio>
+#include <cstring>
+
+static float lerp(float a, float b, float t) {
+    return a + (b - a) * t;
+}
+
+MatchRenderer::MatchRenderer(TextureManager& tm, SpriteBatch& batch)
+    : textureManager(tm), spriteBatch(batch), arrowTexture(tm.getTextureId("arrow")), animationLibrary(tm) {
+    CharacterAnimations& dauSi = characterAnimations[DAU_SI];
+    dauSi.idle = animationLibrary.addAnimation("dausi_idle", "dausi_idle", 0.1f, true, 10);
+    dauSi.run = animationLibrary.addAnimation("dausi_run", "dausi_run", 0.1f, true, 6);
+    dauSi.attack = animationLibrary.addAnimation("dausi_attack", "dausi_attack", 0.01f, false, 4);
+
+    // Sheet XaThu có độ phân giải gấp đôi bản gốc 64x64 nên mỗi pixel ảnh vẽ thành CHARACTER_SCALE / 2 pixel
+    CharacterAnimations& xaThu = characterAnimations[XA_THU];
+    xaThu.idle = animationLibrary.addAnimation("xathu_idle", "xathu_idle", 0.1f, true, 8);
+    xaThu.run = animationLibrary.addAnimation("xathu_run", "xathu_running", 0.1f, true, 8);
+    xaThu.pixelScale = CHARACTER_SCALE * 0.5f;
+}
+
+void MatchRenderer::loadCharacterTextures(CharacterType type) {
+    const char* group = type == DAU_SI ? "dausi" : "xathu";
+    for (const AssetEntry& entry : SPRITE_ASSETS) {
+        if (entry.group && std::strcmp(entry.group, group) == 0) {
+            textureManager.loadTextureAsync(entry.key, entry.path);
+        }
+    }
+}
+
+void MatchRenderer::beginMatch(const MatchSimulation& sim) {
+    CharacterType types[2] = { sim.state.p1Type, sim.state.p2Type };
+    for (int i = 0; i < 2; ++i) {
+        CharacterView& view = views[i];
+        view.animationController = std::make_unique<AnimationController>(animationLibrary);
+        view.animations = &characterAnimations[types[i]];
+        view.isAttacking = false;
+        view.seenAttackTime = -1.0f;
+    }
+}
+
+void MatchRenderer::draw(const MatchSimulation& sim, float alpha) {
+    if (!sim.hasPlayers() || !views[0].animationController) return;
+    PROFILE_ZONE("MatchRenderer::draw");
+    float currentTime = sim.time();
+    animationLibrary.refresh();
+
+    // Cập nhật animation trước rồi lấy frame của mọi nhân vật còn sống trong một lần gọi.
+    // Sau updateAnimation mỗi nhân vật luôn đang phát idle, run hoặc attack nên id hợp lệ
+    int players[2];
+    AnimationId animationIds[2];
+    float elapsed[2];
+    uint32_t frameIndices[2];
+    size_t count = 0;
+    for (int i = 0; i < 2; ++i) {
+        if (sim.health(i).isDead) continue;
+        updateAnimation(sim, i, views[i], currentTime);
+        players[count] = i;
+        animationIds[count] = views[i].animationController->getCurrentAnimation();
+        elapsed[count] = views[i].animationController->getElapsed(currentTime);
+        ++count;
+    }
+    animationLibrary.sampleMany(animationIds, elapsed, count, frameIndices);
+    for (size_t i = 0; i < count; ++i) {
+        int player = players[i];
+        drawCharacter(sim, player, views[player], animationLibrary.frame(frameIndices[i]), alpha);
+    }
+
+    for (int i = 0; i < sim.state.projectiles.count; ++i) {
+        drawProjectile(sim.state.projectiles, i, alpha);
+    }
+
+    const ComponentArray<Buff>& buffs = sim.state.entities.buffs;
+    for (size_t i = 0; i < buffs.size(); ++i) {
+        drawBuff(sim.state.entities.transforms.get(buffs.entityAt(i)), buffs[i]);
+    }
+
+    for (int i = 0; i < 2; ++i) {
+        const Health& health = sim.health(i);
+        if (!health.isDead && health.damageNumberCount > 0) {
+            drawDamageNumbers(health);
+        }
+    }
+}
+
+void MatchRenderer::updateAnimation(const MatchSimulation& sim, int player, CharacterView& view, float currentTime) {
+    AnimationController& animationController = *view.animationController;
+    const CharacterAnimations& animations = *view.animations;
+    const AnimationState& state = sim.animation(player);
+
+    if (state.attackStartTime > view.seenAttackTime) {
+        view.seenAttackTime = state.attackStartTime;
+        animationController.playAnimation(animations.attack, state.attackStartTime);
+        view.isAttacking = true;
+    }
+
+    if (view.isAttacking && animationController.hasFinished(animations.attack, currentTime)) {
+        view.isAttacking = false;
+    }
+
+    if (!view.isAttacking) {
+        if (state.isMoving)
+            animationController.playAnimation(animations.run, currentTime);
+        else
+            animationController.playAnimation(animations.idle, currentTime);
+    }
+}
+
+void MatchRenderer::drawCharacter(const MatchSimulation& sim, int player, const CharacterView& view, const AnimationFrame& frame, float alpha) {
+    const CharacterAnimations& animations = *view.animations;
+    const Transform& c = sim.transform(player);
+
+    float x = lerp(c.prevX, c.x, alpha);
+    float y = lerp(c.prevY, c.y, alpha);
+    float width = c.size * CHARACTER_SCALE;
+    float height = c.size * CHARACTER_SCALE;
+    if (animations.pixelScale > 0.0f && frame.width > 0.0f) {
+        width = frame.width * animations.pixelScale;
+        height = frame.height * animations.pixelScale;
+    }
+
+    if (frame.textureID != 0) {
+        float u0 = c.facingRight ? frame.u0 : frame.u1;
+        float u1 = c.facingRight ? frame.u1 : frame.u0;
+        // Texture được lật dọc khi tải nên đổi v0 và v1
+        spriteBatch.draw(frame.textureID, x, y, x + width, y + height,
+            u0, frame.v1, u1, frame.v0, LAYER_CHARACTERS);
+    }
+    else {
+        spriteBatch.drawRect(x, y, x + width, y + height, sim.fighter(player).color, LAYER_CHARACTERS);
+    }
+}
+
+void MatchRenderer::drawProjectile(const ProjectilePool& projectiles, int index, float alpha) {
+    float x = lerp(projectiles.prevX[index], projectiles.x[index], alpha);
+    float y = lerp(projectiles.prevY[index], projectiles.y[index], alpha);
+    const TextureRegion& arrow = textureManager.getRegion(arrowTexture);
+    if (arrow.textureID != 0) {
+        spriteBatch.draw(arrow.textureID, x, y, x + 50, y + 30, arrow.u0, arrow.v0, arrow.u1, arrow.v1, LAYER_PROJECTILES);
+    }
+    else {
+        spriteBatch.drawRect(x, y, x + 10, y + 5, projectiles.color[index], LAYER_PROJECTILES);
+    }
+    LOG_TRACE("Drawing projectile at x={}, y={}", x, y);
+}
+
+void MatchRenderer::drawBuff(const Transform& t, const Buff& buff) {
+    spriteBatch.drawRect(t.x, t.y, t.x + t.size, t.y + t.size, buff.color, LAYER_BUFFS);
+}
+
+void MatchRenderer::drawDamageNumbers(const Health& health) {
+    for (int i = 0; i < health.damageNumberCount; ++i) {
+        const DamageNumber& dn = health.damageNumbers[i];
+        char buffer[32];
+        snprintf(buffer, sizeof(buffer), "%.1f", dn.value);
+        ImGui::GetForegroundDrawList()->AddText(ImVec2(dn.x, dn.y), ImColor(1.0f, 1.0f, 1.0f, 1.0f), buffer);
+    }
+}
@@ -0,0 +1,54 @@
+﻿#ifndef MATCH_RENDERER_HPP
+#define MATCH_RENDERER_HPP
+
+#include "match_simulation.hpp"
+#include "animation.hpp"
+#include "texture_manager.hpp"
+#include "sprite_batch.hpp"
+#include <memory>
+
+// Vẽ trạng thái của MatchSimulation, nội suy giữa hai tick.
+// Sprite của thế giới đi qua SpriteBatch, số sát thương vẽ bằng ImGui.
+class MatchRenderer {
+public:
+    MatchRenderer(TextureManager& textureManager, SpriteBatch& spriteBatch);
+
+    // Tải texture ở thread nền cho một loại tướng nếu atlas chưa có (gọi khi người chơi chọn tướng)
+    void loadCharacterTextures(CharacterType type);
+    // Tạo animation cho hai người chơi của trận vừa bắt đầu
+    void beginMatch(const MatchSimulation& sim);
+    // alpha: phần đã trôi qua của tick hiện tại, trong khoảng [0, 1)
+    void draw(const MatchSimulation& sim, float alpha);
+
+private:
+    // Animation của một loại tướng trong AnimationLibrary
+    struct CharacterAnimations {
+        AnimationId idle = NO_ANIMATION;
+        AnimationId run = NO_ANIMATION;
+        AnimationId attack = NO_ANIMATION;
+        float pixelScale = 0.0f; // Số pixel màn hình cho mỗi pixel ảnh, 0 = vẽ vừa ô của nhân vật
+    };
+
+    struct CharacterView {
+        std::unique_ptr<AnimationController> animationController;
+        const CharacterAnimations* animations = nullptr;
+        bool isAttacking = false;
+        float seenAttackTime = -1.0f;
+    };
+
+    // Chọn animation theo trạng thái nhân vật (tấn công, chạy, đứng yên)
+    void updateAnimation(const MatchSimulation& sim, int player, CharacterView& view, float currentTime);
+    void drawCharacter(const MatchSimulation& sim, int player, const CharacterView& view, const AnimationFrame& frame, float alpha);
+    void drawProjectile(const ProjectilePool& projectiles, int index, float alpha);
+    void drawBuff(const Transform& transform, const Buff& buff);
+    void drawDamageNumbers(const Health& health);
+
+    TextureManager& textureManager;
+    SpriteBatch& spriteBatch;
+    TextureId arrowTexture;
+    AnimationLibrary animationLibrary;
+    CharacterAnimations characterAnimations[2]; // Theo CharacterType
+    CharacterView views[2];
+};
+
+#endif // MATCH_RENDERER_HPP
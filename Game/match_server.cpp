@@ -0,0 +1,390 @@
+﻿#include "match_server.hpp"
+#include "logger.hpp"
+#include "match_snapshot.hpp"
+#include "profiler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <unordered_map>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+const int SERVER_INPUT_HISTORY = 128;          // Lũy thừa của 2; client gửi trước quá chừng này frame thì bị bỏ
+const double MATCH_START_DELAY = 0.1;          // Snapshot tick 0 đến client trước khi tick đầu chạy
+const double JOIN_TIMEOUT = 10.0;              // Trận chờ đối thủ lâu hơn thì bị hủy
+const double CLIENT_TIMEOUT = 5.0;             // Cả hai client im lặng lâu hơn thì trận bị dừng
+const double IDLE_WAIT = 0.05;                 // Worker không có trận nào đang chạy thì thức dậy mỗi chừng này giây
+const int MAX_CATCH_UP_TICKS = 4;              // Worker bị chậm thì chạy bù tối đa chừng này tick rồi dời lịch
+const uint32_t LINGER_TICKS = TICK_RATE / 2;   // Sau khi kết thúc vẫn gửi snapshot cuối phòng gói bị mất
+const int MAX_PACKETS_PER_WAKE = 1024;         // Bị dội gói thì vẫn chạy tick đúng hạn
+const uint32_t NO_SNAPSHOT_ACK = 0xFFFFFFFFu;  // Client chưa báo nhận snapshot nào: gửi bản đầy đủ
+
+struct MatchServer::HostedMatch {
+    bool inUse = false;
+    uint32_t matchId = 0;
+    bool joined[2] = { false, false };
+    NetAddress clients[2];
+    CharacterType characters[2] = { XA_THU, XA_THU };
+    double lastHeard[2] = { 0.0, 0.0 };
+    double createdAt = 0.0;
+    bool started = false;
+    bool finished = false;
+    double startAt = 0.0;    // Lúc tick 0 đến lượt
+    uint32_t nextTick = 0;   // Tick kế tiếp theo lịch, tính cả các tick chờ sau khi kết thúc
+    uint32_t lingerTicks = 0;
+    double totalStepUs = 0.0;
+    uint8_t inputs[2][SERVER_INPUT_HISTORY] = {};
+    uint32_t inputCount[2] = { 0, 0 }; // Đã nhận input của các frame [0, inputCount)
+    uint32_t snapshotAck[2] = { NO_SNAPSHOT_ACK, NO_SNAPSHOT_ACK };
+    SnapshotHistory sentSnapshots; // Baseline cho delta của từng client
+    MatchSimulation sim;
+    ServerMatchReport report;
+
+    double dueAt() const { return startAt + nextTick * static_cast<double>(TICK_DT); }
+};
+
+struct MatchServer::Worker {
+    unsigned index = 0;
+    UdpSocket socket;
+    NetPoller poller;
+    std::thread thread;
+    std::vector<std::unique_ptr<HostedMatch>> matches; // Ô đã cấp được dùng lại sau khi trận xong
+    std::unordered_map<uint32_t, HostedMatch*> byId;
+    ServerWorkerStats stats;
+    uint8_t receiveBuffer[MAX_UDP_PACKET_SIZE];
+    uint8_t sendBuffer[MAX_UDP_PACKET_SIZE];
+    uint8_t snapshotBuffer[MAX_SNAPSHOT_SIZE];
+    MatchSnapshot snapshot;
+};
+
+static_assert(MAX_SNAPSHOT_SIZE + 16 <= MAX_UDP_PACKET_SIZE, "a full snapshot must fit in one packet");
+
+static double nowSeconds() {
+    return Profiler::nowNanos() * 1e-9;
+}
+
+static bool pinCurrentThread(unsigned cpu) {
+#ifdef _WIN32
+    return SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(1) << (cpu % 64)) != 0;
+#else
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu % CPU_SETSIZE, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#endif
+}
+
+MatchServer::MatchServer() : running(false) {
+}
+
+MatchServer::~MatchServer() {
+    stop();
+}
+
+bool MatchServer::start(const ServerOptions& options) {
+    stop();
+    this->options = options;
+    this->options.snapshotInterval = std::max(1, options.snapshotInterval);
+    unsigned count = options.workers ? options.workers : std::max(1u, std::thread::hardware_concurrency());
+
+    workers.clear();
+    for (unsigned i = 0; i < count; ++i) {
+        std::unique_ptr<Worker> worker(new Worker());
+        worker->index = i;
+        uint16_t port = static_cast<uint16_t>(options.port + i);
+        if (!worker->socket.open(port) || !worker->poller.add(worker->socket, i)) {
+            LOG_ERROR("Could not open UDP port {}", port);
+            workers.clear();
+            return false;
+        }
+        worker->byId.reserve(options.maxMatchesPerWorker * 2);
+        workers.push_back(std::move(worker));
+    }
+
+    running.store(true);
+    for (std::unique_ptr<Worker>& worker : workers) {
+        Worker* w = worker.get();
+        w->thread = std::thread([this, w] { workerLoop(*w); });
+    }
+    LOG_INFO("Match server listening on UDP ports {}-{} with {} workers", options.port, options.port + count - 1, count);
+    return true;
+}
+
+void MatchServer::stop() {
+    running.store(false);
+    for (std::unique_ptr<Worker>& worker : workers) {
+        if (worker->thread.joinable()) worker->thread.join();
+    }
+}
+
+const ServerWorkerStats& MatchServer::workerStats(unsigned worker) const {
+    return workers[worker]->stats;
+}
+
+void MatchServer::takeReports(std::vector<ServerMatchReport>& out) {
+    std::lock_guard<std::mutex> lock(reportMutex);
+    for (ServerMatchReport& report : reports) out.push_back(std::move(report));
+    reports.clear();
+}
+
+void MatchServer::workerLoop(Worker& worker) {
+    Profiler::setThreadName("Server worker");
+    if (options.pinThreads) {
+        unsigned cpus = std::max(1u, std::thread::hardware_concurrency());
+        if (!pinCurrentThread(worker.index % cpus)) LOG_WARN("Could not pin worker {} to a CPU", worker.index);
+    }
+
+    std::vector<uint32_t> ready;
+    ready.reserve(1);
+    double busyStart = nowSeconds();
+    while (running.load(std::memory_order_relaxed)) {
+        // Ngủ đến tick gần nhất trong các trận của worker; làm tròn lên để không phải quay vòng
+        double now = nowSeconds();
+        double wakeAt = now + IDLE_WAIT;
+        for (const std::unique_ptr<HostedMatch>& match : worker.matches) {
+            if (match->inUse && match->started) wakeAt = std::min(wakeAt, match->dueAt());
+        }
+        int timeoutMs = wakeAt <= now ? 0 : static_cast<int>(std::ceil((wakeAt - now) * 1000.0));
+        worker.stats.busyMicros.fetch_add(static_cast<uint64_t>((now - busyStart) * 1e6), std::memory_order_relaxed);
+        worker.poller.wait(timeoutMs, ready);
+        busyStart = nowSeconds();
+
+        NetAddress from;
+        size_t size;
+        for (int i = 0; i < MAX_PACKETS_PER_WAKE; ++i) {
+            size = worker.socket.receive(from, worker.receiveBuffer, sizeof(worker.receiveBuffer));
+            if (size == 0) break;
+            worker.stats.packetsReceived.fetch_add(1, std::memory_order_relaxed);
+            handlePacket(worker, from, worker.receiveBuffer, size, busyStart);
+        }
+
+        now = nowSeconds();
+        for (const std::unique_ptr<HostedMatch>& slot : worker.matches) {
+            HostedMatch& match = *slot;
+            if (!match.inUse) continue;
+            if (!match.started) {
+                if (now - match.createdAt > JOIN_TIMEOUT) {
+                    LOG_WARN("Match {} cancelled: opponent never joined", match.matchId);
+                    match.finished = true;
+                    match.lingerTicks = 0;
+                }
+            }
+            else if (!match.finished && now - std::max(match.lastHeard[0], match.lastHeard[1]) > CLIENT_TIMEOUT) {
+                LOG_WARN("Match {} abandoned at tick {}", match.matchId, match.sim.state.tick);
+                match.report.abandoned = true;
+                finishMatch(match);
+                match.lingerTicks = 0;
+            }
+            else {
+                for (int caughtUp = 0; caughtUp < MAX_CATCH_UP_TICKS && match.dueAt() <= now && match.inUse; ++caughtUp) {
+                    tickMatch(worker, match);
+                }
+                // Vẫn còn chậm: bỏ các tick đã lỡ khỏi lịch thay vì chạy dồn, trận chậm lại một chút
+                if (match.inUse && match.dueAt() <= now) match.startAt = now - match.nextTick * static_cast<double>(TICK_DT);
+            }
+
+            if (match.finished && match.lingerTicks == 0 && match.inUse) {
+                match.inUse = false;
+                worker.byId.erase(match.matchId);
+                worker.stats.activeMatches.fetch_sub(1, std::memory_order_relaxed);
+            }
+        }
+    }
+}
+
+void MatchServer::handlePacket(Worker& worker, const NetAddress& from, const uint8_t* data, size_t size, double now) {
+    ServerPacket packet;
+    if (!readServerPacket(data, size, packet) || (packet.type != PACKET_JOIN && packet.type != PACKET_INPUT)) {
+        worker.stats.packetsRejected.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    ServerPacket reply;
+    reply.matchId = packet.matchId;
+    reply.player = packet.player;
+    auto found = worker.byId.find(packet.matchId);
+    HostedMatch* match = found != worker.byId.end() ? found->second : nullptr;
+
+    if (packet.type == PACKET_JOIN) {
+        unsigned owner = packet.matchId % workers.size();
+        if (owner != worker.index) {
+            reply.type = PACKET_REDIRECT;
+            reply.port = static_cast<uint16_t>(options.port + owner);
+            send(worker, from, reply);
+            return;
+        }
+        if (!match) {
+            for (const std::unique_ptr<HostedMatch>& slot : worker.matches) {
+                if (!slot->inUse) { match = slot.get(); break; }
+            }
+            if (!match && worker.matches.size() < static_cast<size_t>(options.maxMatchesPerWorker)) {
+                worker.matches.emplace_back(new HostedMatch());
+                match = worker.matches.back().get();
+            }
+            if (!match) {
+                reply.type = PACKET_REJECT;
+                send(worker, from, reply);
+                return;
+            }
+            match->inUse = true;
+            match->matchId = packet.matchId;
+            match->joined[0] = match->joined[1] = false;
+            match->createdAt = now;
+            match->started = false;
+            match->finished = false;
+            worker.byId[packet.matchId] = match;
+            worker.stats.activeMatches.fetch_add(1, std::memory_order_relaxed);
+        }
+        int p = packet.player;
+        if ((match->joined[p] && match->clients[p] != from) || match->finished) {
+            reply.type = PACKET_REJECT;
+            send(worker, from, reply);
+            return;
+        }
+        match->joined[p] = true;
+        match->clients[p] = from;
+        match->characters[p] = static_cast<CharacterType>(packet.character);
+        match->lastHeard[p] = now;
+        reply.type = PACKET_WELCOME;
+        send(worker, from, reply);
+        if (!match->started && match->joined[1 - p]) startMatch(worker, *match, now);
+        return;
+    }
+
+    // Chỉ nhận input từ đúng địa chỉ đã JOIN vai đó
+    int p = packet.player;
+    if (!match || !match->joined[p] || match->clients[p] != from) {
+        worker.stats.packetsRejected.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    match->lastHeard[p] = now;
+    if (!match->started || match->finished) return;
+    // Gói INPUT có thể đến sai thứ tự: chỉ tiến ack lên
+    uint32_t& ack = match->snapshotAck[p];
+    if (packet.snapshotAck <= match->sim.state.tick && (ack == NO_SNAPSHOT_ACK || packet.snapshotAck > ack)) {
+        ack = packet.snapshotAck;
+    }
+
+    uint32_t tick = match->sim.state.tick;
+    for (uint32_t i = 0; i < packet.inputCount; ++i) {
+        uint32_t f = packet.firstFrame + i;
+        if (f < match->inputCount[p]) continue;
+        if (f > match->inputCount[p] || f >= tick + SERVER_INPUT_HISTORY) break;
+        match->inputs[p][f & (SERVER_INPUT_HISTORY - 1)] = packet.buttons[i];
+        ++match->inputCount[p];
+    }
+}
+
+void MatchServer::startMatch(Worker& worker, HostedMatch& match, double now) {
+    uint64_t seedState = options.seed + match.matchId;
+    match.sim.start(match.characters[0], match.characters[1], static_cast<uint32_t>(MatchRng::splitMix64(seedState)));
+    match.started = true;
+    match.startAt = now + MATCH_START_DELAY;
+    match.nextTick = 0;
+    match.lingerTicks = 0;
+    match.totalStepUs = 0.0;
+    match.inputCount[0] = match.inputCount[1] = 0;
+    match.snapshotAck[0] = match.snapshotAck[1] = NO_SNAPSHOT_ACK;
+    match.sentSnapshots.clear();
+    match.report = ServerMatchReport();
+    match.report.matchId = match.matchId;
+    match.report.worker = worker.index;
+    if (options.recordReplays) match.report.replay.begin(match.sim);
+    sendSnapshot(worker, match);
+}
+
+void MatchServer::tickMatch(Worker& worker, HostedMatch& match) {
+    double due = match.dueAt();
+    ++match.nextTick;
+    if (match.finished) {
+        if (match.lingerTicks > 0 && --match.lingerTicks % options.snapshotInterval == 0) sendSnapshot(worker, match);
+        return;
+    }
+    PROFILE_ZONE("MatchServer::tickMatch");
+
+    MatchInput input;
+    uint32_t tick = match.sim.state.tick;
+    for (int p = 0; p < 2; ++p) {
+        uint32_t received = match.inputCount[p];
+        if (tick < received) {
+            input.buttons[p] = match.inputs[p][tick & (SERVER_INPUT_HISTORY - 1)];
+        }
+        else {
+            // Chưa có input của tick này: giữ nguyên nút gần nhất đã nhận
+            input.buttons[p] = received > 0 ? match.inputs[p][(received - 1) & (SERVER_INPUT_HISTORY - 1)] : 0;
+            ++match.report.missingInputs[p];
+            // Coi như đã nhận nút đó cho các frame đến hết tick này: input đến sau bị bỏ,
+            // client thấy chúng đã được xác nhận và chuỗi input của hai bên không lệch nhau
+            while (match.inputCount[p] <= tick) {
+                match.inputs[p][match.inputCount[p]++ & (SERVER_INPUT_HISTORY - 1)] = input.buttons[p];
+            }
+        }
+    }
+    if (options.recordReplays) match.report.replay.record(input);
+
+    double stepStart = nowSeconds();
+    match.sim.step(input);
+    double stepEnd = nowSeconds();
+
+    double stepUs = (stepEnd - stepStart) * 1e6;
+    match.totalStepUs += stepUs;
+    match.report.maxStepUs = std::max(match.report.maxStepUs, stepUs);
+    match.report.maxLateMs = std::max(match.report.maxLateMs, (stepStart - due) * 1e3);
+    if (stepEnd > due + TICK_DT) {
+        ++match.report.overruns;
+        worker.stats.overruns.fetch_add(1, std::memory_order_relaxed);
+    }
+    worker.stats.ticks.fetch_add(1, std::memory_order_relaxed);
+
+    bool over = !match.sim.isRunning() || match.sim.state.tick >= options.maxTicks;
+    if (over || match.sim.state.tick % options.snapshotInterval == 0) sendSnapshot(worker, match);
+    if (over) finishMatch(match);
+}
+
+void MatchServer::finishMatch(HostedMatch& match) {
+    ServerMatchReport& report = match.report;
+    report.ticks = match.sim.state.tick;
+    report.winner = match.sim.winner();
+    report.avgStepUs = report.ticks > 0 ? match.totalStepUs / report.ticks : 0.0;
+    report.resultHash = replayResultHash(match.sim);
+    if (options.recordReplays) report.replay.finish(match.sim);
+    {
+        std::lock_guard<std::mutex> lock(reportMutex);
+        reports.push_back(std::move(report));
+    }
+    match.finished = true;
+    match.lingerTicks = LINGER_TICKS;
+}
+
+void MatchServer::sendSnapshot(Worker& worker, HostedMatch& match) {
+    captureSnapshot(match.sim, worker.snapshot);
+    // Hết giờ mà trận chưa kết thúc thì client vẫn phải biết là đã xong
+    if (match.sim.state.tick >= options.maxTicks) worker.snapshot.gameEnded = true;
+    // Các snapshot gửi lại sau khi kết thúc trùng tick với bản cuối, không cần lưu thêm
+    if (!match.sentSnapshots.find(worker.snapshot.tick)) match.sentSnapshots.store(worker.snapshot);
+
+    ServerPacket packet;
+    packet.type = PACKET_SNAPSHOT;
+    packet.matchId = match.matchId;
+    packet.payload = worker.snapshotBuffer;
+    for (int p = 0; p < 2; ++p) {
+        // Mỗi client có baseline riêng: snapshot mới nhất nó đã báo nhận
+        const MatchSnapshot* baseline = match.snapshotAck[p] != NO_SNAPSHOT_ACK ? match.sentSnapshots.find(match.snapshotAck[p]) : nullptr;
+        packet.payloadSize = encodeSnapshot(worker.snapshot, baseline, worker.snapshotBuffer, sizeof(worker.snapshotBuffer));
+        packet.firstFrame = match.inputCount[p];
+        send(worker, match.clients[p], packet);
+    }
+}
+
+void MatchServer::send(Worker& worker, const NetAddress& to, const ServerPacket& packet) {
+    size_t size = writeServerPacket(packet, worker.sendBuffer);
+    worker.socket.send(to, worker.sendBuffer, size);
+    worker.stats.packetsSent.fetch_add(1, std::memory_order_relaxed);
+}
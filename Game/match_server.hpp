@@ -0,0 +1,93 @@
+﻿#ifndef MATCH_SERVER_HPP
+#define MATCH_SERVER_HPP
+
+#include "replay.hpp"
+#include "server_protocol.hpp"
+#include "udp_socket.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+struct ServerOptions {
+    uint16_t port = 7777;        // Worker i nghe ở port + i
+    unsigned workers = 0;        // 0 = mọi nhân CPU
+    int maxMatchesPerWorker = 128;
+    uint64_t seed = 1;           // Seed của trận = splitMix64(seed + matchId)
+    uint32_t maxTicks = 180 * TICK_RATE; // Hết giờ tính hòa
+    int snapshotInterval = 2;    // Gửi snapshot mỗi chừng này tick
+    bool pinThreads = true;      // Gắn worker i vào nhân CPU i
+    bool recordReplays = false;  // Đính Replay vào báo cáo của từng trận
+};
+
+// Kết quả và thời gian tick của một trận đã xong
+struct ServerMatchReport {
+    uint32_t matchId = 0;
+    unsigned worker = 0;
+    uint32_t ticks = 0;
+    int winner = 0;              // Như MatchSimulation::winner()
+    bool abandoned = false;      // Cả hai client im lặng quá lâu nên trận bị dừng
+    uint32_t overruns = 0;       // Tick xong sau hạn: quá TICK_DT kể từ lúc đến lượt
+    double maxLateMs = 0.0;      // Tick bắt đầu trễ nhất so với lịch
+    double avgStepUs = 0.0;
+    double maxStepUs = 0.0;
+    uint32_t missingInputs[2] = { 0, 0 }; // Tick phải lặp lại nút cũ vì input chưa đến kịp
+    uint32_t resultHash = 0;     // replayResultHash() lúc kết thúc
+    Replay replay;               // Chỉ có khi ServerOptions::recordReplays
+};
+
+// Số liệu cộng dồn của một worker, đọc được từ thread khác bất cứ lúc nào
+struct ServerWorkerStats {
+    std::atomic<uint32_t> activeMatches{ 0 };
+    std::atomic<uint64_t> ticks{ 0 };
+    std::atomic<uint64_t> overruns{ 0 };
+    std::atomic<uint64_t> packetsReceived{ 0 };
+    std::atomic<uint64_t> packetsSent{ 0 };
+    std::atomic<uint64_t> packetsRejected{ 0 }; // Gói hỏng, sai địa chỉ hoặc của trận không tồn tại
+    std::atomic<uint64_t> busyMicros{ 0 };      // Thời gian không nằm chờ trong NetPoller
+};
+
+// Dedicated server có thẩm quyền: chạy MatchSimulation của mọi trận, client chỉ gửi nút bấm
+// và nhận snapshot. Mỗi worker thread giữ một socket UDP (cổng port + i), một NetPoller và
+// các trận có matchId % workers == i, nên một trận chỉ được chạm bởi đúng một thread và không
+// cần khóa. Worker ngủ trong NetPoller đến khi có gói hoặc đến tick kế tiếp của trận gần nhất;
+// mỗi trận có lịch tick riêng tính từ lúc đủ hai người chơi.
+// Input chưa đến kịp tick của nó thì lặp lại nút gần nhất, input đến muộn bị bỏ.
+class MatchServer {
+public:
+    MatchServer();
+    ~MatchServer();
+
+    // Mở socket và chạy các worker; false nếu không mở được cổng nào đó
+    bool start(const ServerOptions& options);
+    void stop();
+
+    unsigned workerCount() const { return static_cast<unsigned>(workers.size()); }
+    const ServerWorkerStats& workerStats(unsigned worker) const;
+    // Chuyển các báo cáo trận đã xong từ lần gọi trước vào out
+    void takeReports(std::vector<ServerMatchReport>& out);
+
+private:
+    struct HostedMatch;
+    struct Worker;
+
+    void workerLoop(Worker& worker);
+    void handlePacket(Worker& worker, const NetAddress& from, const uint8_t* data, size_t size, double now);
+    void startMatch(Worker& worker, HostedMatch& match, double now);
+    void tickMatch(Worker& worker, HostedMatch& match);
+    void finishMatch(HostedMatch& match);
+    void sendSnapshot(Worker& worker, HostedMatch& match);
+    void send(Worker& worker, const NetAddress& to, const ServerPacket& packet);
+
+    ServerOptions options;
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<bool> running;
+    std::mutex reportMutex;
+    std::vector<ServerMatchReport> reports;
+
+    MatchServer(const MatchServer&) = delete;
+    MatchServer& operator=(const MatchServer&) = delete;
+};
+
+#endif // MATCH_SERVER_HPP
@@ -0,0 +1,230 @@
+﻿#include "match_simulation.hpp"
+#include "hash64.hpp"
+#include "logger.hpp"
+#include "profiler.hpp"
+#include <algorithm>
+#include <cstring>
+
+const float SPAWN_INTERVAL = 15.0f;
+
+MatchSimulation::MatchSimulation() {
+    reset();
+    queryResults[0].reserve(MAX_MATCH_ENTITIES);
+    queryResults[1].reserve(MAX_MATCH_ENTITIES);
+}
+
+void MatchSimulation::start(CharacterType p1Type, CharacterType p2Type, uint32_t seed) {
+    reset();
+    state.seed = seed;
+    state.rng.seed(seed);
+    state.p1Type = p1Type;
+    state.p2Type = p2Type;
+    EntityStore& entities = state.entities;
+    EntityId* players = state.players;
+    players[0] = createCharacter(entities, p1Type, 150.0f, WINDOW_HEIGHT - 50.0f, Color{ 1.0f, 0.0f, 0.0f, 1.0f }, 0);
+    players[1] = createCharacter(entities, p2Type, 1350.0f, WINDOW_HEIGHT - 50.0f, Color{ 0.0f, 1.0f, 1.0f, 1.0f }, 1);
+    for (int i = 0; i < 2; ++i) {
+        int handle = state.collisions.add(collisionBox(entities.transforms.get(players[i])), COLLIDE_CHARACTER, players[i]);
+        entities.colliders.add(players[i], Collider{ handle });
+    }
+}
+
+void MatchSimulation::reset() {
+    // Xóa cả byte đệm để hai sim chạy cùng input luôn có state giống nhau từng byte
+    std::memset(static_cast<void*>(&state), 0, sizeof(MatchState));
+    state.entities.clear();
+    state.collisions.clear();
+    state.projectiles.clear();
+    state.players[0] = state.players[1] = NO_ENTITY;
+    state.p1Type = state.p2Type = XA_THU;
+    state.rng.seed(0);
+    state.buffMessageType[0] = state.buffMessageType[1] = -1;
+}
+
+uint64_t stateChecksum(const MatchState& state) {
+    return xxHash64(&state, sizeof(MatchState));
+}
+
+int MatchSimulation::winner() const {
+    if (!state.gameEnded) return 0;
+    bool p1Dead = health(0).isDead, p2Dead = health(1).isDead;
+    if (p1Dead && !p2Dead) return 2;
+    if (p2Dead && !p1Dead) return 1;
+    return 0;
+}
+
+void MatchSimulation::step(const MatchInput& input) {
+    ++state.tick;
+    if (!isRunning()) return;
+    PROFILE_ZONE("MatchSimulation::step");
+
+    float currentTime = time();
+    PlayerInput inputs[2] = { { input.buttons[0], state.previousButtons[0] }, { input.buttons[1], state.previousButtons[1] } };
+    state.previousButtons[0] = input.buttons[0];
+    state.previousButtons[1] = input.buttons[1];
+
+    // Các system chung duyệt thẳng mảng component liền nhau
+    for (size_t i = 0; i < state.entities.transforms.size(); ++i) {
+        Transform& t = state.entities.transforms[i];
+        t.prevX = t.x;
+        t.prevY = t.y;
+    }
+    for (size_t i = 0; i < state.entities.healths.size(); ++i) {
+        Health& h = state.entities.healths[i];
+        if (!h.isDead && h.damageNumberCount > 0) updateDamageNumbers(h, currentTime);
+    }
+
+    CharacterRef refs[2] = { characterRef(state.entities, state.players[0]), characterRef(state.entities, state.players[1]) };
+    for (int player = 0; player < 2; ++player) {
+        if (!refs[player].health->isDead) stepPlayer(refs[player], refs[1 - player], inputs[player], currentTime);
+    }
+    updateProjectiles(refs, currentTime);
+    for (const CharacterRef& ref : refs) {
+        state.collisions.update(state.entities.colliders.get(ref.id).handle, collisionBox(*ref.transform));
+    }
+
+    if (currentTime - state.lastSpawnTime > SPAWN_INTERVAL) {
+        state.lastSpawnTime = currentTime;
+        spawnBuff();
+    }
+    updateBuffs(currentTime);
+
+    // Thêm/xóa buff có thể dời component nên lấy lại từ store
+    Health& h1 = state.entities.healths.get(state.players[0]);
+    Health& h2 = state.entities.healths.get(state.players[1]);
+    if (h1.health <= 0 || h2.health <= 0) {
+        state.gameEndTime = currentTime;
+        state.gameEnded = true;
+        if (h1.health <= 0) h1.isDead = true;
+        if (h2.health <= 0) h2.isDead = true;
+    }
+}
+
+CollisionBox MatchSimulation::collisionBox(const Transform& t) {
+    float scaledSize = t.size * CHARACTER_SCALE;
+    return { t.x, t.y, t.x + scaledSize, t.y + scaledSize };
+}
+
+void MatchSimulation::stepPlayer(CharacterRef& self, CharacterRef& target, const PlayerInput& input, float currentTime) {
+    moveCharacter(self, input);
+    dodgeCharacter(self, input, currentTime);
+    attackCharacter(self, target, input, currentTime, state.rng, state.projectiles);
+    useCharacterSkill(self, target, input, currentTime, state.rng, state.projectiles);
+}
+
+void MatchSimulation::updateProjectiles(CharacterRef* refs, float currentTime) {
+    // Mũi tên trúng khi đoạn đường nó đi trong tick cắt dải 40%-60% chiều cao của đối thủ
+    ProjectilePool& projectiles = state.projectiles;
+    ProjectileTarget targets[2];
+    for (int t = 0; t < 2; ++t) {
+        const Transform& transform = *refs[t].transform;
+        float targetSize = transform.size * CHARACTER_SCALE;
+        targets[t] = { transform.x, transform.x + targetSize,
+            transform.y + targetSize * 0.4f, transform.y + targetSize * 0.6f };
+    }
+    projectiles.update(targets, 2);
+
+    for (int i = 0; i < projectiles.count; ) {
+        if (projectiles.active[i]) {
+            int targetIndex = 1 - projectiles.owner[i];
+            if (projectiles.hitMask[i] & (1 << targetIndex)) {
+                CharacterRef& shooter = refs[projectiles.owner[i]];
+                CharacterRef& target = refs[targetIndex];
+                if (projectiles.hits[i]) {
+                    shooter.fighter->damageDealt[projectiles.source[i]] += takeDamage(target, projectiles.damage[i], currentTime);
+                    LOG_TRACE("Projectile swept through target midsection, damage: {}", projectiles.damage[i]);
+                }
+                projectiles.active[i] = 0;
+            }
+        }
+        if (!projectiles.active[i]) {
+            projectiles.despawn(i);
+            LOG_TRACE("Projectile removed, remaining: {}", projectiles.count);
+        }
+        else {
+            ++i;
+        }
+    }
+}
+
+void MatchSimulation::spawnBuff() {
+    if (state.entities.buffs.size() >= static_cast<size_t>(MAX_BUFFS)) return;
+
+    float randomX = (WINDOW_WIDTH / 3.0f) + state.rng.nextBelow(static_cast<uint32_t>(WINDOW_WIDTH / 3.0f));
+    float randomY = (WINDOW_HEIGHT / 3.0f) + state.rng.nextBelow(static_cast<uint32_t>(WINDOW_HEIGHT / 3.0f));
+
+    // Buff được giới hạn theo kích thước chưa nhân CHARACTER_SCALE
+    float scaledSize = 50.0f;
+    float LEFT_LIMIT = -100.0f;
+    float RIGHT_LIMIT = WINDOW_WIDTH - scaledSize + 100.0f;
+    float GRASS_TOP = 300.0f;
+    float GRASS_BOTTOM = WINDOW_HEIGHT - scaledSize + 89.0f;
+
+    float spawnX = std::clamp(randomX, LEFT_LIMIT, RIGHT_LIMIT);
+    float spawnY = std::clamp(randomY, GRASS_TOP, GRASS_BOTTOM);
+    BuffType buff = static_cast<BuffType>(state.rng.nextBelow(4));
+    Color buffColor = (buff == BUFF_DAMAGE_BOOST) ? Color{ 1.0f, 0.5f, 0.5f, 1.0f } :
+        (buff == BUFF_HEAL) ? Color{ 0.5f, 1.0f, 0.5f, 1.0f } :
+        (buff == BUFF_SHIELD) ? Color{ 0.5f, 0.5f, 1.0f, 1.0f } :
+        Color{ 0.5f, 0.5f, 0.5f, 1.0f };
+    EntityId item = createBuff(state.entities, spawnX, spawnY, buffColor, buff);
+    if (item == NO_ENTITY) return;
+    int handle = state.collisions.add(collisionBox(state.entities.transforms.get(item)), COLLIDE_BUFF, item);
+    if (handle < 0) {
+        // Broadphase đầy: buff không có collider thì không nhặt được, bỏ luôn
+        state.entities.destroy(item);
+        return;
+    }
+    state.entities.colliders.add(item, Collider{ handle });
+}
+
+void MatchSimulation::updateBuffs(float currentTime) {
+    // Mỗi người chơi chỉ xét các buff ở gần qua broadphase thay vì mọi buff
+    for (int i = 0; i < 2; ++i) {
+        queryResults[i].clear();
+        if (!health(i).isDead) {
+            state.collisions.query(collisionBox(transform(i)), COLLIDE_BUFF, queryResults[i]);
+        }
+    }
+
+    // Gộp hai danh sách (đã sắp xếp); người chơi 1 được ưu tiên khi cả hai cùng chạm
+    const std::vector<int>& hits1 = queryResults[0];
+    const std::vector<int>& hits2 = queryResults[1];
+    size_t a = 0, b = 0;
+    while (a < hits1.size() || b < hits2.size()) {
+        int handle;
+        bool p1Hit = false, p2Hit = false;
+        if (b >= hits2.size() || (a < hits1.size() && hits1[a] < hits2[b])) {
+            handle = hits1[a++];
+            p1Hit = true;
+        }
+        else if (a >= hits1.size() || hits2[b] < hits1[a]) {
+            handle = hits2[b++];
+            p2Hit = true;
+        }
+        else {
+            handle = hits1[a++];
+            ++b;
+            p1Hit = p2Hit = true;
+        }
+
+        int pickerIndex = -1;
+        if (p1Hit) {
+            if (!fighter(0).isDodging) pickerIndex = 0;
+        }
+        else if (p2Hit) {
+            if (!fighter(1).isDodging) pickerIndex = 1;
+        }
+
+        if (pickerIndex >= 0) {
+            EntityId item = state.collisions.userData(handle);
+            BuffType type = state.entities.buffs.get(item).type;
+            CharacterRef picker = characterRef(state.entities, state.players[pickerIndex]);
+            applyBuff(type, picker);
+            state.buffMessageType[pickerIndex] = type;
+            state.buffMessageTime[pickerIndex] = currentTime;
+            state.collisions.remove(handle);
+            state.entities.destroy(item);
+        }
+    }
+}
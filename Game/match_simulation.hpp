@@ -0,0 +1,86 @@
+﻿#ifndef MATCH_SIMULATION_HPP
+#define MATCH_SIMULATION_HPP
+
+#include "character.hpp"
+#include "entity_store.hpp"
+#include "projectile_pool.hpp"
+#include "spatial_hash.hpp"
+#include "player_input.hpp"
+#include "game_config.hpp"
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Toàn bộ trạng thái của một trận trong một khối liền, kích thước cố định, không con trỏ:
+// sao chép bằng phép gán (memcpy) là có ngay một ảnh chụp dùng được ở bất kỳ đâu, cho
+// rollback, replay, tìm kiếm của AI hay thử trạng thái ngẫu nhiên. Khối được xóa về 0 trước
+// mỗi trận và các component không có byte đệm ngầm, nên checksum() theo từng byte là xác định.
+struct MatchState {
+    EntityStore entities;    // Nhân vật và buff
+    SpatialHash collisions;  // Nhân vật và buff, cập nhật mỗi tick
+    ProjectilePool projectiles;
+    EntityId players[2];
+    CharacterType p1Type, p2Type;
+    uint32_t tick;
+    uint32_t seed;
+    MatchRng rng;
+    float lastSpawnTime;
+    float gameEndTime;
+    int buffMessageType[2];   // Loại buff nhặt gần nhất của mỗi người chơi, -1 nếu chưa có
+    float buffMessageTime[2];
+    uint8_t previousButtons[2];
+    bool gameEnded;
+};
+
+static_assert(std::is_trivially_copyable<MatchState>::value, "MatchState is saved and restored with memcpy");
+
+// xxHash64 của cả khối, để so trạng thái giữa các máy hoặc các lần chạy
+uint64_t stateChecksum(const MatchState& state);
+
+// Toàn bộ logic một trận đấu, chạy theo tick cố định và không phụ thuộc GLFW/ImGui.
+// Mọi dữ liệu của trận nằm trong state nên step() không cấp phát.
+class MatchSimulation {
+public:
+    MatchSimulation();
+
+    // Tạo nhân vật cho hai người chơi và bắt đầu trận từ tick 0.
+    // Cùng seed và cùng chuỗi input sẽ cho ra cùng một trận đấu.
+    void start(CharacterType p1Type, CharacterType p2Type, uint32_t seed);
+    // Bỏ nhân vật và buff của trận hiện tại
+    void reset();
+    // Tiến trận đấu thêm một tick với input của hai người chơi
+    void step(const MatchInput& input);
+    // Chụp và khôi phục state bằng memcpy, sao chép cả byte đệm để checksum() giữ nguyên
+    void save(MatchState& snapshot) const { std::memcpy(&snapshot, &state, sizeof(MatchState)); }
+    void restore(const MatchState& snapshot) { std::memcpy(&state, &snapshot, sizeof(MatchState)); }
+    uint64_t checksum() const { return stateChecksum(state); }
+
+    float time() const { return state.tick * TICK_DT; }
+    bool hasPlayers() const { return state.players[0] != NO_ENTITY && state.players[1] != NO_ENTITY; }
+    bool isRunning() const { return hasPlayers() && !state.gameEnded; }
+    // 1 hoặc 2 nếu có người thắng, 0 nếu hòa hoặc trận chưa kết thúc
+    int winner() const;
+
+    // Component của người chơi 0 (P1) hoặc 1 (P2); chỉ gọi khi hasPlayers()
+    const Transform& transform(int player) const { return state.entities.transforms.get(state.players[player]); }
+    const Health& health(int player) const { return state.entities.healths.get(state.players[player]); }
+    const Fighter& fighter(int player) const { return state.entities.fighters.get(state.players[player]); }
+    const AnimationState& animation(int player) const { return state.entities.animations.get(state.players[player]); }
+
+    MatchState state;
+
+private:
+    static CollisionBox collisionBox(const Transform& t);
+    void stepPlayer(CharacterRef& self, CharacterRef& target, const PlayerInput& input, float currentTime);
+    void updateProjectiles(CharacterRef* refs, float currentTime);
+    void spawnBuff();
+    void updateBuffs(float currentTime);
+
+    std::vector<int> queryResults[2]; // Bộ nhớ tạm của updateBuffs, không thuộc state
+
+    MatchSimulation(const MatchSimulation&) = delete;
+    MatchSimulation& operator=(const MatchSimulation&) = delete;
+};
+
+#endif // MATCH_SIMULATION_HPP
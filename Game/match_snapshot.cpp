@@ -0,0 +1,275 @@
+﻿#include "match_snapshot.hpp"
+#include "bit_stream.hpp"
+#include <algorithm>
+#include <cmath>
+
+// Số bit của từng trường trên dây
+const int TICK_BITS = 32;
+const int BASELINE_OFFSET_BITS = 16; // Khoảng cách tick tới baseline
+const int WINNER_BITS = 2;
+const int TYPE_BITS = 1;
+const int FLAG_BITS = 5;
+const int SIZE_BITS = 10;
+const int HEALTH_BITS = 12;
+const int SPEED_BITS = 12;
+const int COOLDOWN_BITS = 10;
+const int COUNT_BITS = 7; // Số buff hoặc mũi tên, tối đa 64
+const int BUFF_TYPE_BITS = 2;
+const int OWNER_BITS = 1;
+const int VELOCITY_BITS = 9;
+const int SMALL_DELTA_BITS = 6; // Độ lệch nhỏ -32..31 sau zigzag
+const int VELOCITY_STEPS_PER_POSITION = 4; // SNAPSHOT_VELOCITY_SCALE / SNAPSHOT_POSITION_SCALE
+
+static_assert(MAX_BUFFS < (1 << COUNT_BITS) && MAX_SNAPSHOT_PROJECTILES < (1 << COUNT_BITS), "counts must fit COUNT_BITS");
+static_assert(2 * SNAPSHOT_VELOCITY_LIMIT < (1 << VELOCITY_BITS), "velocity must fit VELOCITY_BITS");
+
+static uint32_t fieldMask(int bits) {
+    return bits >= 32 ? 0xFFFFFFFFu : (1u << bits) - 1;
+}
+
+static uint16_t quantize(float value, float scale, int bits) {
+    float q = std::round(value * scale);
+    return static_cast<uint16_t>(std::clamp(q, 0.0f, static_cast<float>(fieldMask(bits))));
+}
+
+static uint16_t cooldownTicks(float lastTime, float cooldown, float currentTime) {
+    float remaining = lastTime + cooldown - currentTime;
+    if (remaining <= 0.0f) return 0;
+    return static_cast<uint16_t>(std::min<float>(std::ceil(remaining * TICK_RATE), static_cast<float>(fieldMask(COOLDOWN_BITS))));
+}
+
+static int16_t quantizeVelocity(float velocity) {
+    float q = std::round(velocity * SNAPSHOT_VELOCITY_SCALE);
+    return static_cast<int16_t>(std::clamp(q, static_cast<float>(-SNAPSHOT_VELOCITY_LIMIT), static_cast<float>(SNAPSHOT_VELOCITY_LIMIT)));
+}
+
+void SnapshotHistory::store(const MatchSnapshot& snapshot) {
+    entries[next] = snapshot;
+    next = (next + 1) % SNAPSHOT_HISTORY;
+    count = std::min(count + 1, SNAPSHOT_HISTORY);
+}
+
+const MatchSnapshot* SnapshotHistory::find(uint32_t tick) const {
+    for (int i = 0; i < count; ++i) {
+        if (entries[i].tick == tick) return &entries[i];
+    }
+    return nullptr;
+}
+
+void captureSnapshot(const MatchSimulation& sim, MatchSnapshot& snapshot) {
+    const MatchState& state = sim.state;
+    float currentTime = sim.time();
+    snapshot.tick = state.tick;
+    snapshot.gameEnded = state.gameEnded;
+    snapshot.winner = static_cast<uint8_t>(sim.winner());
+
+    for (int p = 0; p < 2; ++p) {
+        const Transform& t = sim.transform(p);
+        const Health& h = sim.health(p);
+        const Fighter& f = sim.fighter(p);
+        const Cooldowns& cd = state.entities.cooldowns.get(state.players[p]);
+        SnapshotPlayer& player = snapshot.players[p];
+        player.x = quantize(t.x + SNAPSHOT_MARGIN, SNAPSHOT_POSITION_SCALE, SNAPSHOT_X_BITS);
+        player.y = quantize(t.y + SNAPSHOT_MARGIN, SNAPSHOT_POSITION_SCALE, SNAPSHOT_Y_BITS);
+        player.size = quantize(t.size, SNAPSHOT_SIZE_SCALE, SIZE_BITS);
+        player.health = quantize(h.health, SNAPSHOT_HEALTH_SCALE, HEALTH_BITS);
+        player.maxHealth = quantize(h.maxHealth, SNAPSHOT_HEALTH_SCALE, HEALTH_BITS);
+        player.speed = quantize(f.speed, SNAPSHOT_SPEED_SCALE, SPEED_BITS);
+        player.cooldownTicks[SNAPSHOT_ATTACK] = cooldownTicks(cd.lastAttackTime, cd.attackCooldown, currentTime);
+        player.cooldownTicks[SNAPSHOT_SKILL] = cooldownTicks(cd.lastSkillTime, cd.skillCooldown, currentTime);
+        player.cooldownTicks[SNAPSHOT_DODGE] = cooldownTicks(cd.lastDodgeTime, cd.dodgeCooldown, currentTime);
+        player.type = static_cast<uint8_t>(f.type);
+        player.flags = (t.facingRight ? SNAPSHOT_FACING_RIGHT : 0) | (h.isDead ? SNAPSHOT_DEAD : 0) |
+            (f.isDodging ? SNAPSHOT_DODGING : 0) | (h.shielded ? SNAPSHOT_SHIELDED : 0) |
+            (sim.animation(p).isMoving ? SNAPSHOT_MOVING : 0);
+    }
+
+    const ComponentArray<Buff>& buffs = state.entities.buffs;
+    snapshot.buffCount = static_cast<int>(buffs.size());
+    for (int i = 0; i < snapshot.buffCount; ++i) {
+        const Transform& t = state.entities.transforms.get(buffs.entityAt(i));
+        SnapshotBuff& buff = snapshot.buffs[i];
+        buff.x = quantize(t.x + SNAPSHOT_MARGIN, SNAPSHOT_POSITION_SCALE, SNAPSHOT_X_BITS);
+        buff.y = quantize(t.y + SNAPSHOT_MARGIN, SNAPSHOT_POSITION_SCALE, SNAPSHOT_Y_BITS);
+        buff.type = static_cast<uint8_t>(buffs[i].type);
+    }
+
+    const ProjectilePool& projectiles = state.projectiles;
+    snapshot.projectileCount = std::min(projectiles.count, MAX_SNAPSHOT_PROJECTILES);
+    for (int i = 0; i < snapshot.projectileCount; ++i) {
+        SnapshotProjectile& projectile = snapshot.projectiles[i];
+        projectile.x = quantize(projectiles.x[i] + SNAPSHOT_MARGIN, SNAPSHOT_POSITION_SCALE, SNAPSHOT_X_BITS);
+        projectile.y = quantize(projectiles.y[i] + SNAPSHOT_MARGIN, SNAPSHOT_POSITION_SCALE, SNAPSHOT_Y_BITS);
+        projectile.velocityX = quantizeVelocity(projectiles.velocityX[i]);
+        projectile.velocityY = quantizeVelocity(projectiles.velocityY[i]);
+        projectile.owner = projectiles.owner[i];
+    }
+}
+
+// Mã tiền tố của một trường so với giá trị dự đoán base: 0 = không đổi, 10 + độ lệch nhỏ
+// (zigzag), 11 + giá trị đầy đủ. Đa số trường giữa hai snapshot gần nhau chỉ tốn 1 bit
+static void writeField(BitWriter& writer, uint32_t value, uint32_t base, int bits) {
+    if (value == base) {
+        writer.write(0, 1);
+        return;
+    }
+    int32_t delta = static_cast<int32_t>(value - base);
+    uint32_t zigzag = (static_cast<uint32_t>(delta) << 1) ^ static_cast<uint32_t>(delta >> 31);
+    if (bits > SMALL_DELTA_BITS && zigzag < (1u << SMALL_DELTA_BITS)) {
+        writer.write(1, 2);
+        writer.write(zigzag, SMALL_DELTA_BITS);
+    }
+    else {
+        writer.write(3, 2);
+        writer.write(value, bits);
+    }
+}
+
+static uint32_t readField(BitReader& reader, uint32_t base, int bits) {
+    if (reader.read(1) == 0) return base;
+    if (reader.read(1) == 0) {
+        uint32_t zigzag = reader.read(SMALL_DELTA_BITS);
+        int32_t delta = static_cast<int32_t>(zigzag >> 1) ^ -static_cast<int32_t>(zigzag & 1);
+        return (base + static_cast<uint32_t>(delta)) & fieldMask(bits);
+    }
+    return reader.read(bits);
+}
+
+// Vận tốc lệch SNAPSHOT_VELOCITY_LIMIT để ghi như số không dấu
+static uint32_t velocityField(int16_t velocity) {
+    return static_cast<uint32_t>(velocity + SNAPSHOT_VELOCITY_LIMIT);
+}
+
+static int16_t velocityFromField(uint32_t field) {
+    return static_cast<int16_t>(std::min<int>(static_cast<int>(field), 2 * SNAPSHOT_VELOCITY_LIMIT) - SNAPSHOT_VELOCITY_LIMIT);
+}
+
+// Vị trí mũi tên của baseline sau ticks tick bay thẳng với vận tốc của baseline
+static uint32_t predictPosition(uint16_t position, int16_t velocity, uint32_t ticks, int bits) {
+    int64_t moved = static_cast<int64_t>(velocity) * ticks;
+    int64_t half = moved >= 0 ? VELOCITY_STEPS_PER_POSITION / 2 : -VELOCITY_STEPS_PER_POSITION / 2;
+    int64_t predicted = position + (moved + half) / VELOCITY_STEPS_PER_POSITION;
+    return static_cast<uint32_t>(std::clamp<int64_t>(predicted, 0, fieldMask(bits)));
+}
+
+static bool sameBuffs(const MatchSnapshot& a, const MatchSnapshot& b) {
+    if (a.buffCount != b.buffCount) return false;
+    for (int i = 0; i < a.buffCount; ++i) {
+        if (a.buffs[i].x != b.buffs[i].x || a.buffs[i].y != b.buffs[i].y || a.buffs[i].type != b.buffs[i].type) return false;
+    }
+    return true;
+}
+
+// Baseline của bản đầy đủ: mọi trường bằng 0
+static const MatchSnapshot EMPTY_SNAPSHOT = {};
+
+size_t encodeSnapshot(const MatchSnapshot& snapshot, const MatchSnapshot* baseline, uint8_t* out, size_t capacity) {
+    uint32_t offset = baseline ? snapshot.tick - baseline->tick : 0;
+    if (offset == 0 || offset > fieldMask(BASELINE_OFFSET_BITS)) baseline = nullptr;
+    const MatchSnapshot& base = baseline ? *baseline : EMPTY_SNAPSHOT;
+
+    BitWriter writer(out, capacity);
+    writer.write(snapshot.tick, TICK_BITS);
+    writer.write(baseline ? offset : 0, BASELINE_OFFSET_BITS);
+    writer.write(snapshot.gameEnded ? 1 : 0, 1);
+    writer.write(snapshot.winner, WINNER_BITS);
+
+    for (int p = 0; p < 2; ++p) {
+        const SnapshotPlayer& player = snapshot.players[p];
+        const SnapshotPlayer& old = base.players[p];
+        writeField(writer, player.x, old.x, SNAPSHOT_X_BITS);
+        writeField(writer, player.y, old.y, SNAPSHOT_Y_BITS);
+        writeField(writer, player.size, old.size, SIZE_BITS);
+        writeField(writer, player.health, old.health, HEALTH_BITS);
+        writeField(writer, player.maxHealth, old.maxHealth, HEALTH_BITS);
+        writeField(writer, player.speed, old.speed, SPEED_BITS);
+        for (int c = 0; c < SNAPSHOT_COOLDOWN_COUNT; ++c) {
+            writeField(writer, player.cooldownTicks[c], old.cooldownTicks[c], COOLDOWN_BITS);
+        }
+        writeField(writer, player.type, old.type, TYPE_BITS);
+        writeField(writer, player.flags, old.flags, FLAG_BITS);
+    }
+
+    // Buff chỉ đổi khi sinh hoặc bị nhặt: thường cả danh sách giống baseline
+    bool buffsUnchanged = baseline && sameBuffs(snapshot, base);
+    writer.write(buffsUnchanged ? 1 : 0, 1);
+    if (!buffsUnchanged) {
+        writer.write(static_cast<uint32_t>(snapshot.buffCount), COUNT_BITS);
+        for (int i = 0; i < snapshot.buffCount; ++i) {
+            const SnapshotBuff& buff = snapshot.buffs[i];
+            const SnapshotBuff& old = i < base.buffCount ? base.buffs[i] : EMPTY_SNAPSHOT.buffs[0];
+            writeField(writer, buff.x, old.x, SNAPSHOT_X_BITS);
+            writeField(writer, buff.y, old.y, SNAPSHOT_Y_BITS);
+            writeField(writer, buff.type, old.type, BUFF_TYPE_BITS);
+        }
+    }
+
+    writer.write(static_cast<uint32_t>(snapshot.projectileCount), COUNT_BITS);
+    for (int i = 0; i < snapshot.projectileCount; ++i) {
+        const SnapshotProjectile& projectile = snapshot.projectiles[i];
+        const SnapshotProjectile& old = i < base.projectileCount ? base.projectiles[i] : EMPTY_SNAPSHOT.projectiles[0];
+        writer.write(projectile.owner, OWNER_BITS);
+        writeField(writer, velocityField(projectile.velocityX), velocityField(old.velocityX), VELOCITY_BITS);
+        writeField(writer, velocityField(projectile.velocityY), velocityField(old.velocityY), VELOCITY_BITS);
+        writeField(writer, projectile.x, predictPosition(old.x, old.velocityX, offset, SNAPSHOT_X_BITS), SNAPSHOT_X_BITS);
+        writeField(writer, projectile.y, predictPosition(old.y, old.velocityY, offset, SNAPSHOT_Y_BITS), SNAPSHOT_Y_BITS);
+    }
+    return writer.finish();
+}
+
+bool decodeSnapshot(const uint8_t* data, size_t size, const SnapshotHistory& history, MatchSnapshot& snapshot) {
+    BitReader reader(data, size);
+    snapshot.tick = reader.read(TICK_BITS);
+    uint32_t offset = reader.read(BASELINE_OFFSET_BITS);
+    const MatchSnapshot* baseline = offset != 0 ? history.find(snapshot.tick - offset) : &EMPTY_SNAPSHOT;
+    if (!baseline || reader.hasFailed()) return false;
+    const MatchSnapshot& base = *baseline;
+    snapshot.gameEnded = reader.read(1) != 0;
+    snapshot.winner = static_cast<uint8_t>(reader.read(WINNER_BITS));
+
+    for (int p = 0; p < 2; ++p) {
+        SnapshotPlayer& player = snapshot.players[p];
+        const SnapshotPlayer& old = base.players[p];
+        player.x = static_cast<uint16_t>(readField(reader, old.x, SNAPSHOT_X_BITS));
+        player.y = static_cast<uint16_t>(readField(reader, old.y, SNAPSHOT_Y_BITS));
+        player.size = static_cast<uint16_t>(readField(reader, old.size, SIZE_BITS));
+        player.health = static_cast<uint16_t>(readField(reader, old.health, HEALTH_BITS));
+        player.maxHealth = static_cast<uint16_t>(readField(reader, old.maxHealth, HEALTH_BITS));
+        player.speed = static_cast<uint16_t>(readField(reader, old.speed, SPEED_BITS));
+        for (int c = 0; c < SNAPSHOT_COOLDOWN_COUNT; ++c) {
+            player.cooldownTicks[c] = static_cast<uint16_t>(readField(reader, old.cooldownTicks[c], COOLDOWN_BITS));
+        }
+        player.type = static_cast<uint8_t>(readField(reader, old.type, TYPE_BITS));
+        player.flags = static_cast<uint8_t>(readField(reader, old.flags, FLAG_BITS));
+    }
+
+    if (reader.read(1) != 0) {
+        if (offset == 0) return false;
+        snapshot.buffCount = base.buffCount;
+        std::copy(base.buffs, base.buffs + base.buffCount, snapshot.buffs);
+    }
+    else {
+        snapshot.buffCount = static_cast<int>(reader.read(COUNT_BITS));
+        if (snapshot.buffCount > MAX_BUFFS) return false;
+        for (int i = 0; i < snapshot.buffCount; ++i) {
+            SnapshotBuff& buff = snapshot.buffs[i];
+            const SnapshotBuff& old = i < base.buffCount ? base.buffs[i] : EMPTY_SNAPSHOT.buffs[0];
+            buff.x = static_cast<uint16_t>(readField(reader, old.x, SNAPSHOT_X_BITS));
+            buff.y = static_cast<uint16_t>(readField(reader, old.y, SNAPSHOT_Y_BITS));
+            buff.type = static_cast<uint8_t>(readField(reader, old.type, BUFF_TYPE_BITS));
+        }
+    }
+
+    snapshot.projectileCount = static_cast<int>(reader.read(COUNT_BITS));
+    if (snapshot.projectileCount > MAX_SNAPSHOT_PROJECTILES) return false;
+    for (int i = 0; i < snapshot.projectileCount; ++i) {
+        SnapshotProjectile& projectile = snapshot.projectiles[i];
+        const SnapshotProjectile& old = i < base.projectileCount ? base.projectiles[i] : EMPTY_SNAPSHOT.projectiles[0];
+        projectile.owner = static_cast<uint8_t>(reader.read(OWNER_BITS));
+        projectile.velocityX = velocityFromField(readField(reader, velocityField(old.velocityX), VELOCITY_BITS));
+        projectile.velocityY = velocityFromField(readField(reader, velocityField(old.velocityY), VELOCITY_BITS));
+        projectile.x = static_cast<uint16_t>(readField(reader, predictPosition(old.x, old.velocityX, offset, SNAPSHOT_X_BITS), SNAPSHOT_X_BITS));
+        projectile.y = static_cast<uint16_t>(readField(reader, predictPosition(old.y, old.velocityY, offset, SNAPSHOT_Y_BITS), SNAPSHOT_Y_BITS));
+    }
+    return reader.finished();
+}
@@ -0,0 +1,106 @@
+﻿#ifndef MATCH_SNAPSHOT_HPP
+#define MATCH_SNAPSHOT_HPP
+
+#include "match_simulation.hpp"
+#include <cstddef>
+#include <cstdint>
+
+const int MAX_SNAPSHOT_PROJECTILES = 64; // Nhiều hơn thì chỉ gửi 64 mũi tên đầu tiên trong pool
+const int SNAPSHOT_HISTORY = 32;         // Baseline cũ hơn chừng này snapshot thì gửi bản đầy đủ
+
+// Toạ độ lượng tử theo bước 1/4 px trong sân mở rộng SNAPSHOT_MARGIN mỗi phía (người chơi
+// được đi quá mép 100 px); giá trị 0 ứng với -SNAPSHOT_MARGIN
+const float SNAPSHOT_POSITION_SCALE = 4.0f;
+const float SNAPSHOT_MARGIN = 128.0f;
+const int SNAPSHOT_X_BITS = 13; // (1500 + 256) * 4 < 2^13
+const int SNAPSHOT_Y_BITS = 13; // (900 + 256) * 4 < 2^13
+const float SNAPSHOT_HEALTH_SCALE = 10.0f;   // Bước 0.1 máu
+const float SNAPSHOT_SPEED_SCALE = 16.0f;    // Tốc độ di chuyển, bước 1/16 px mỗi tick
+const float SNAPSHOT_SIZE_SCALE = 4.0f;
+const float SNAPSHOT_VELOCITY_SCALE = 16.0f; // Vận tốc mũi tên, bước 1/16 px mỗi tick
+const int SNAPSHOT_VELOCITY_LIMIT = 255;     // |vận tốc| tối đa sau lượng tử, vừa 9 bit có dấu
+
+enum SnapshotPlayerFlag : uint8_t {
+    SNAPSHOT_FACING_RIGHT = 1 << 0,
+    SNAPSHOT_DEAD = 1 << 1,
+    SNAPSHOT_DODGING = 1 << 2,
+    SNAPSHOT_SHIELDED = 1 << 3,
+    SNAPSHOT_MOVING = 1 << 4
+};
+
+enum SnapshotCooldown {
+    SNAPSHOT_ATTACK,
+    SNAPSHOT_SKILL,
+    SNAPSHOT_DODGE,
+    SNAPSHOT_COOLDOWN_COUNT
+};
+
+// Mọi trường đã lượng tử: snapshot so sánh được bằng số nguyên và client giải mã ra đúng
+// những gì server dùng làm baseline. Đổi về đơn vị game bằng các hàm snapshot*() bên dưới
+struct SnapshotPlayer {
+    uint16_t x, y;
+    uint16_t size; // Cạnh hộp va chạm trước khi nhân CHARACTER_SCALE
+    uint16_t health, maxHealth;
+    uint16_t speed;
+    uint16_t cooldownTicks[SNAPSHOT_COOLDOWN_COUNT]; // Số tick còn lại trước khi dùng lại được
+    uint8_t type;  // CharacterType
+    uint8_t flags; // SnapshotPlayerFlag
+};
+
+struct SnapshotBuff {
+    uint16_t x, y;
+    uint8_t type; // BuffType
+};
+
+struct SnapshotProjectile {
+    uint16_t x, y;
+    int16_t velocityX, velocityY;
+    uint8_t owner;
+};
+
+// Phần của MatchState mà client cần để vẽ và điều khiển, server gửi sau mỗi vài tick
+struct MatchSnapshot {
+    uint32_t tick;
+    bool gameEnded;
+    uint8_t winner; // MatchSimulation::winner()
+    SnapshotPlayer players[2];
+    int buffCount;
+    SnapshotBuff buffs[MAX_BUFFS];
+    int projectileCount;
+    SnapshotProjectile projectiles[MAX_SNAPSHOT_PROJECTILES];
+};
+
+inline float snapshotX(uint16_t x) { return x / SNAPSHOT_POSITION_SCALE - SNAPSHOT_MARGIN; }
+inline float snapshotY(uint16_t y) { return y / SNAPSHOT_POSITION_SCALE - SNAPSHOT_MARGIN; }
+inline float snapshotHealth(uint16_t health) { return health / SNAPSHOT_HEALTH_SCALE; }
+inline float snapshotSpeed(uint16_t speed) { return speed / SNAPSHOT_SPEED_SCALE; }
+inline float snapshotSize(uint16_t size) { return size / SNAPSHOT_SIZE_SCALE; }
+inline float snapshotVelocity(int16_t velocity) { return velocity / SNAPSHOT_VELOCITY_SCALE; }
+
+// Các snapshot gần nhất: server giữ những gì đã gửi, client giữ những gì đã nhận, để hai
+// bên cùng tìm ra baseline theo tick mà client báo đã nhận
+class SnapshotHistory {
+public:
+    void clear() { count = 0; next = 0; }
+    void store(const MatchSnapshot& snapshot);
+    // nullptr nếu không còn giữ snapshot của tick này
+    const MatchSnapshot* find(uint32_t tick) const;
+
+private:
+    MatchSnapshot entries[SNAPSHOT_HISTORY];
+    int count = 0;
+    int next = 0;
+};
+
+// Bản đầy đủ lớn nhất (64 buff, 64 mũi tên, mọi trường ở giá trị lớn nhất) chiếm 737 byte
+const size_t MAX_SNAPSHOT_SIZE = 768;
+
+// sim phải có người chơi
+void captureSnapshot(const MatchSimulation& sim, MatchSnapshot& snapshot);
+// Mã hoá snapshot thành dòng bit, chỉ ghi trường khác baseline (dự đoán vị trí mũi tên theo
+// vận tốc); baseline nullptr thì ghi bản đầy đủ. Trả về số byte ghi vào out, 0 nếu quá capacity
+size_t encodeSnapshot(const MatchSnapshot& snapshot, const MatchSnapshot* baseline, uint8_t* out, size_t capacity);
+// false nếu dữ liệu hỏng hoặc history không còn baseline mà server đã dùng
+bool decodeSnapshot(const uint8_t* data, size_t size, const SnapshotHistory& history, MatchSnapshot& snapshot);
+
+#endif // MATCH_SNAPSHOT_HPP
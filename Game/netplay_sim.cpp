@@ -0,0 +1,268 @@
+﻿#include "rollback.hpp"
+#include "loopback_transport.hpp"
+#include "match_bot.hpp"
+#include "logger.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+// Chạy trận PvP qua RollbackSession giữa hai "máy" trong cùng process, nối bằng LoopbackTransport
+// có độ trễ, jitter và mất gói. Mỗi trận được so với một sim chạy thẳng bằng input thật của hai bên
+// để phát hiện lệch trạng thái, đồng thời đo chi phí rollback.
+// Ví dụ: netplay_sim --matches 200 --latency 80 --jitter 30 --loss 10 --delay 2 --max-prediction 8
+
+struct NetplayOptions {
+    int matches = 100;
+    uint64_t seed = 1;
+    uint32_t maxTicks = 180 * TICK_RATE;
+    LinkConditions link;
+    int inputDelay = 2;
+    int maxPrediction = 8;
+    bool verbose = false;
+};
+
+struct NetplayResult {
+    bool synchronized = false; // Hai bên cùng frame và đã có đủ input thật
+    bool matched = false;      // Và khớp với sim chạy thẳng
+    bool desyncDetected = false; // Một trong hai máy thấy checksum khác đối thủ
+    uint32_t frames[2] = {};
+    RollbackStats stats[2];
+    double advanceMicros = 0.0;
+    double maxAdvanceMicros = 0.0;
+    uint32_t advanceCalls = 0;
+};
+
+// Tách seed gốc thành seed độc lập cho từng trận
+static uint64_t splitMix64(uint64_t value) {
+    return MatchRng::splitMix64(value);
+}
+
+static const double FRAME_MS = 1000.0 / TICK_RATE;
+static const int MAX_DRAIN_FRAMES = 10 * TICK_RATE;
+
+static void printUsage() {
+    std::fprintf(stderr,
+        "Usage: netplay_sim [options]\n"
+        "  --matches N          so tran (mac dinh 100)\n"
+        "  --seed N             seed goc (mac dinh 1)\n"
+        "  --max-ticks N        so tick toi da moi tran\n"
+        "  --latency MS         do tre mot chieu (mac dinh 0)\n"
+        "  --jitter MS          tre them ngau nhien toi da (mac dinh 0)\n"
+        "  --loss PCT           ti le mat goi theo phan tram (mac dinh 0)\n"
+        "  --delay N            input delay theo frame (mac dinh 2)\n"
+        "  --max-prediction N   so frame toi da chay truoc doi thu (mac dinh 8)\n"
+        "  --verbose            in ket qua tung tran\n");
+}
+
+static bool parseOptions(int argc, char** argv, NetplayOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        if (std::strcmp(arg, "--verbose") == 0) { options.verbose = true; continue; }
+        const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (!value) return false;
+        if (std::strcmp(arg, "--matches") == 0) options.matches = std::atoi(value);
+        else if (std::strcmp(arg, "--seed") == 0) options.seed = std::strtoull(value, nullptr, 10);
+        else if (std::strcmp(arg, "--max-ticks") == 0) options.maxTicks = static_cast<uint32_t>(std::atoi(value));
+        else if (std::strcmp(arg, "--latency") == 0) options.link.latencyMs = std::atof(value);
+        else if (std::strcmp(arg, "--jitter") == 0) options.link.jitterMs = std::atof(value);
+        else if (std::strcmp(arg, "--loss") == 0) options.link.lossPercent = static_cast<float>(std::atof(value));
+        else if (std::strcmp(arg, "--delay") == 0) options.inputDelay = std::atoi(value);
+        else if (std::strcmp(arg, "--max-prediction") == 0) options.maxPrediction = std::atoi(value);
+        else return false;
+        ++i;
+    }
+    return options.matches > 0;
+}
+
+// Nhận mọi gói đã đến đầu peer rồi gửi trạng thái input của nó cho đầu kia
+static void exchangePackets(LoopbackTransport& transport, RollbackSession& session, int peer, double nowMs,
+    std::vector<uint8_t>& packet) {
+    while (transport.receive(peer, nowMs, packet)) {
+        session.readPacket(packet.data(), packet.size());
+    }
+    session.writePacket(packet);
+    transport.send(peer, packet.data(), packet.size(), nowMs);
+}
+
+static NetplayResult runMatch(const NetplayOptions& options, uint64_t matchSeed) {
+    NetplayResult result;
+    uint32_t seed = static_cast<uint32_t>(matchSeed);
+    CharacterType p1Type = static_cast<CharacterType>((matchSeed >> 32) & 1);
+    CharacterType p2Type = static_cast<CharacterType>((matchSeed >> 33) & 1);
+
+    // Mỗi máy có sim, phiên và bot riêng; bot chỉ nhìn thấy sim (có dự đoán) của máy mình
+    MatchSimulation sims[2];
+    RollbackSession sessions[2];
+    MatchBot bots[2] = { MatchBot(BOT_SCRIPTED, 0, seed ^ 0x1234u), MatchBot(BOT_SCRIPTED, 1, seed ^ 0x5678u) };
+    std::vector<uint8_t> sentInputs[2]; // Input thật của từng người chơi theo frame
+    for (int peer = 0; peer < 2; ++peer) {
+        sims[peer].start(p1Type, p2Type, seed);
+        sessions[peer].start(sims[peer], peer, options.inputDelay, options.maxPrediction);
+        sentInputs[peer].assign(std::clamp(options.inputDelay, 0, MAX_INPUT_DELAY), 0);
+    }
+    LoopbackTransport transport(options.link, matchSeed);
+    std::vector<uint8_t> packet;
+    packet.reserve(MAX_ROLLBACK_PACKET_SIZE);
+
+    // Cả hai máy chạy theo cùng đồng hồ ảo 60 Hz cho đến khi một máy thấy trận kết thúc;
+    // máy kia dừng theo vì sau đó nó chỉ còn chờ input không bao giờ đến
+    bool playing = true;
+    uint64_t wallFrame = 0;
+    while (playing) {
+        double nowMs = wallFrame++ * FRAME_MS;
+        for (int peer = 0; peer < 2; ++peer) {
+            exchangePackets(transport, sessions[peer], peer, nowMs, packet);
+            uint8_t buttons = bots[peer].think(sims[peer]);
+            auto begin = std::chrono::steady_clock::now();
+            bool advanced = sessions[peer].advance(buttons);
+            double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count();
+            result.advanceMicros += micros;
+            result.maxAdvanceMicros = std::max(result.maxAdvanceMicros, micros);
+            ++result.advanceCalls;
+            if (advanced) sentInputs[peer].push_back(buttons);
+            if (!sims[peer].isRunning() || sessions[peer].currentFrame() >= options.maxTicks) playing = false;
+        }
+    }
+
+    // Hai máy dừng ở các frame khác nhau (máy chạy trước dựa trên dự đoán), nên máy chậm hơn
+    // chạy tiếp với input rỗng đến cùng frame rồi cả hai trao đổi gói cho đến khi đủ input thật
+    uint32_t target = std::max(sessions[0].currentFrame(), sessions[1].currentFrame());
+    for (int i = 0; i < MAX_DRAIN_FRAMES; ++i) {
+        bool done = true;
+        double nowMs = wallFrame++ * FRAME_MS;
+        for (int peer = 0; peer < 2; ++peer) {
+            exchangePackets(transport, sessions[peer], peer, nowMs, packet);
+            if (sessions[peer].currentFrame() < target) {
+                if (sessions[peer].advance(0)) sentInputs[peer].push_back(0);
+            }
+            else {
+                sessions[peer].resolve();
+            }
+            done = done && sessions[peer].currentFrame() == target && sessions[peer].synchronized();
+        }
+        if (done) {
+            result.synchronized = true;
+            break;
+        }
+    }
+    for (int peer = 0; peer < 2; ++peer) {
+        result.frames[peer] = sessions[peer].currentFrame();
+        result.stats[peer] = sessions[peer].stats();
+        result.desyncDetected = result.desyncDetected || sessions[peer].desynced();
+    }
+    if (!result.synchronized) return result;
+
+    // Sim tham chiếu chạy thẳng bằng input thật của hai bên
+    MatchSimulation reference;
+    reference.start(p1Type, p2Type, seed);
+    while (reference.state.tick < target) {
+        MatchInput input;
+        input.buttons[0] = sentInputs[0][reference.state.tick];
+        input.buttons[1] = sentInputs[1][reference.state.tick];
+        reference.step(input);
+    }
+    uint64_t expected = reference.checksum();
+    result.matched = sims[0].checksum() == expected && sims[1].checksum() == expected;
+    return result;
+}
+
+// Chi phí một lần rollback sâu depth frame ở giữa trận: khôi phục ảnh chụp rồi chạy lại depth frame
+static void benchmarkRollback(uint64_t seed, int depth) {
+    const int ITERATIONS = 2000;
+    MatchSimulation sim;
+    std::unique_ptr<MatchState> snapshot = std::make_unique<MatchState>();
+    sim.start(XA_THU, DAU_SI, static_cast<uint32_t>(seed));
+    MatchBot bots[2] = { MatchBot(BOT_SCRIPTED, 0, 1), MatchBot(BOT_SCRIPTED, 1, 2) };
+    auto botInput = [&] {
+        MatchInput input;
+        input.buttons[0] = bots[0].think(sim);
+        input.buttons[1] = bots[1].think(sim);
+        return input;
+    };
+    while (sim.isRunning() && sim.state.tick < 5 * TICK_RATE) {
+        sim.step(botInput());
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; ++i) sim.save(*snapshot);
+    double saveMicros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count() / ITERATIONS;
+
+    begin = std::chrono::steady_clock::now();
+    uint64_t checksum = 0;
+    for (int i = 0; i < ITERATIONS; ++i) checksum += sim.checksum();
+    double checksumMicros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count() / ITERATIONS;
+
+    std::vector<MatchInput> inputs;
+    for (int f = 0; f < depth; ++f) {
+        inputs.push_back(botInput());
+        sim.step(inputs.back());
+    }
+    begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; ++i) {
+        sim.restore(*snapshot);
+        for (const MatchInput& input : inputs) sim.step(input);
+    }
+    double rollbackMicros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count() / ITERATIONS;
+    std::printf("state: %zu bytes, %.2f us save, %.2f us checksum (%016llx)\n", sizeof(MatchState), saveMicros,
+        checksumMicros, static_cast<unsigned long long>(checksum / ITERATIONS));
+    std::printf("rollback of %d frames (restore + resimulate): %.2f us\n", depth, rollbackMicros);
+}
+
+int main(int argc, char** argv) {
+    NetplayOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return 1;
+    }
+    Logger::instance().setLevel(LOG_LEVEL_WARN);
+
+    int matched = 0, desynced = 0, stuck = 0, detected = 0;
+    uint64_t frames = 0;
+    RollbackStats total;
+    double advanceMicros = 0.0, maxAdvanceMicros = 0.0;
+    uint64_t advanceCalls = 0;
+    for (int i = 0; i < options.matches; ++i) {
+        NetplayResult result = runMatch(options, splitMix64(options.seed + i));
+        if (!result.synchronized) ++stuck;
+        else if (result.matched) ++matched;
+        else ++desynced;
+        if (result.desyncDetected) ++detected;
+        for (int peer = 0; peer < 2; ++peer) {
+            const RollbackStats& s = result.stats[peer];
+            frames += result.frames[peer];
+            total.rollbacks += s.rollbacks;
+            total.resimulatedFrames += s.resimulatedFrames;
+            total.maxRollbackDepth = std::max(total.maxRollbackDepth, s.maxRollbackDepth);
+            total.stalledFrames += s.stalledFrames;
+            total.packetsReceived += s.packetsReceived;
+            total.packetsRejected += s.packetsRejected;
+            total.checksumsCompared += s.checksumsCompared;
+        }
+        advanceMicros += result.advanceMicros;
+        maxAdvanceMicros = std::max(maxAdvanceMicros, result.maxAdvanceMicros);
+        advanceCalls += result.advanceCalls;
+        if (options.verbose || (result.synchronized && !result.matched) || result.desyncDetected) {
+            std::printf("match %d: %s%s, frames %u / %u, rollbacks %u / %u, max depth %u / %u\n", i,
+                !result.synchronized ? "STUCK" : result.matched ? "ok" : "DESYNC",
+                result.desyncDetected ? " (checksum mismatch seen in game)" : "",
+                result.frames[0], result.frames[1], result.stats[0].rollbacks, result.stats[1].rollbacks,
+                result.stats[0].maxRollbackDepth, result.stats[1].maxRollbackDepth);
+        }
+    }
+
+    std::printf("%d matches: %d ok, %d desynced, %d stuck; in-game checksums: %u compared, %d matches flagged\n",
+        options.matches, matched, desynced, stuck, total.checksumsCompared, detected);
+    std::printf("link: %.0f ms latency, %.0f ms jitter, %.1f%% loss; input delay %d, max prediction %d\n",
+        options.link.latencyMs, options.link.jitterMs, options.link.lossPercent, options.inputDelay, options.maxPrediction);
+    std::printf("%llu frames, %u rollbacks (%.2f frames avg, %u max), %u frames resimulated, %u stalls\n",
+        static_cast<unsigned long long>(frames), total.rollbacks,
+        total.rollbacks ? static_cast<double>(total.resimulatedFrames) / total.rollbacks : 0.0,
+        total.maxRollbackDepth, total.resimulatedFrames, total.stalledFrames);
+    std::printf("advance(): %.2f us avg, %.2f us max\n", advanceCalls ? advanceMicros / advanceCalls : 0.0, maxAdvanceMicros);
+    benchmarkRollback(options.seed, std::max(options.maxPrediction, 8));
+    return desynced == 0 && stuck == 0 && detected == 0 ? 0 : 1;
+}
@@ -0,0 +1,88 @@
+﻿#include "perf_hud.hpp"
+#include "alloc_counter.hpp"
+#include "imgui.h"
+#include <algorithm>
+
+void PerfSeries::add(float value) {
+    values[next] = value;
+    next = (next + 1) % PERF_HISTORY;
+    if (count < PERF_HISTORY) ++count;
+}
+
+float PerfSeries::percentile(float p) const {
+    if (count == 0) return 0.0f;
+    // Chép ra mảng tạm trên stack vì nth_element làm xáo trộn thứ tự
+    float sorted[PERF_HISTORY];
+    int first = (next + PERF_HISTORY - count) % PERF_HISTORY;
+    for (int i = 0; i < count; ++i) {
+        sorted[i] = values[(first + i) % PERF_HISTORY];
+    }
+    int rank = std::min(count - 1, static_cast<int>(p * count));
+    std::nth_element(sorted, sorted + rank, sorted + count);
+    return sorted[rank];
+}
+
+void PerfSeries::plot(const char* label, float scaleMax) const {
+    int offset = count < PERF_HISTORY ? 0 : next;
+    ImGui::PlotHistogram(label, values, count, offset, nullptr, 0.0f, scaleMax, ImVec2(PERF_HISTORY, 40.0f));
+}
+
+void PerfHud::addFrame(float frameMs, uint64_t frameAllocations) {
+    frameTimes.add(frameMs);
+    allocations.add(static_cast<float>(frameAllocations));
+}
+
+static void drawTimings(const char* label, const PerfSeries& series, float scaleMax) {
+    ImGui::Text("%s  p50 %.2f  p95 %.2f  p99 %.2f ms", label,
+        series.percentile(0.50f), series.percentile(0.95f), series.percentile(0.99f));
+    series.plot(label, scaleMax);
+}
+
+void PerfHud::draw(const MatchSimulation& sim, const TextureManager& textures) const {
+    if (!visible) return;
+
+    ImGui::SetNextWindowPos(ImVec2(10.0f, 120.0f), ImGuiCond_Always);
+    ImGui::SetNextWindowBgAlpha(0.6f);
+    ImGui::Begin("Performance", nullptr, ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize |
+        ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoInputs | ImGuiWindowFlags_NoFocusOnAppearing | ImGuiWindowFlags_NoNav);
+
+    float frameMs = frameTimes.latest();
+    ImGui::Text("Frame %.2f ms (%.0f FPS)", frameMs, frameMs > 0.0f ? 1000.0f / frameMs : 0.0f);
+    drawTimings("Frame", frameTimes, 33.3f);
+    drawTimings("Tick", tickTimes, 2.0f);
+    ImGui::Separator();
+
+    if (!gpuSupported) {
+        ImGui::Text("GPU timings: n/a (no timer queries)");
+    }
+    else {
+        if (gpuEmulated) ImGui::Text("GPU timings: software renderer, CPU-emulated");
+        for (int pass = 0; pass < GPU_PASS_COUNT; ++pass) {
+            const PerfSeries& series = gpuTimes[pass];
+            ImGui::Text("%s  p50 %.2f  p95 %.2f  p99 %.2f ms", GpuTimer::passName(static_cast<GpuPass>(pass)),
+                series.percentile(0.50f), series.percentile(0.95f), series.percentile(0.99f));
+        }
+    }
+    ImGui::Separator();
+
+    ImGui::Text("Draw calls: %d sprite, %d ImGui", renderStats.spriteDrawCalls, renderStats.imguiDrawCalls);
+    // Mỗi sprite là một quad instanced 4 đỉnh
+    ImGui::Text("Vertices: %d sprite, %d ImGui", renderStats.sprites * 4, renderStats.imguiVertices);
+
+    int damageNumbers = 0;
+    for (size_t i = 0; i < sim.state.entities.healths.size(); ++i) {
+        damageNumbers += sim.state.entities.healths[i].damageNumberCount;
+    }
+    ImGui::Text("Projectiles %d  Buffs %d  Damage numbers %d",
+        sim.state.projectiles.size(), static_cast<int>(sim.state.entities.buffs.size()), damageNumbers);
+    ImGui::Text("Textures: %d (%.1f MB)", static_cast<int>(textures.getTextureCount()),
+        textures.getTextureBytes() / (1024.0 * 1024.0));
+
+    if (ALLOC_COUNTER_ENABLED) {
+        ImGui::Text("Allocations/frame: %.0f (max %.0f)", allocations.latest(), allocations.percentile(1.0f));
+    }
+    else {
+        ImGui::Text("Allocations/frame: n/a (ALLOC_COUNTER_ENABLED=0)");
+    }
+    ImGui::End();
+}
@@ -0,0 +1,64 @@
+﻿#ifndef PERF_HUD_HPP
+#define PERF_HUD_HPP
+
+#include "gpu_timer.hpp"
+#include "match_simulation.hpp"
+#include "texture_manager.hpp"
+#include <cstdint>
+
+const int PERF_HISTORY = 240; // Số mẫu giữ lại, khoảng 4 giây ở 60 FPS
+
+// Các mẫu gần nhất của một chỉ số trong bộ đệm vòng, đủ để vẽ biểu đồ và tính phân vị
+class PerfSeries {
+public:
+    void add(float value);
+    // p trong [0, 1]; 0 nếu chưa có mẫu
+    float percentile(float p) const;
+    float latest() const { return count > 0 ? values[(next + PERF_HISTORY - 1) % PERF_HISTORY] : 0.0f; }
+    int size() const { return count; }
+    // Vẽ bằng ImGui::PlotHistogram, mẫu cũ nhất ở bên trái
+    void plot(const char* label, float scaleMax) const;
+
+private:
+    float values[PERF_HISTORY] = {};
+    int next = 0;
+    int count = 0;
+};
+
+// Số liệu vẽ của frame vừa xong, lấy sau ImGui::Render
+struct PerfRenderStats {
+    int spriteDrawCalls = 0;
+    int sprites = 0;
+    int imguiDrawCalls = 0;
+    int imguiVertices = 0;
+};
+
+// Bảng hiệu năng bật/tắt bằng F3: thời gian frame và tick (p50/p95/p99), số draw call và
+// vertex, thời gian GPU của từng pass, số vật thể trong trận, bộ nhớ texture và số lần cấp phát mỗi frame.
+// Chỉ đọc số liệu sẵn có và không cấp phát, để bật trong bản đang chạy mà không làm sai số đo.
+class PerfHud {
+public:
+    void toggle() { visible = !visible; }
+    bool isVisible() const { return visible; }
+
+    void addFrame(float frameMs, uint64_t allocations);
+    void addTick(float tickMs) { tickTimes.add(tickMs); }
+    void setRenderStats(const PerfRenderStats& stats) { renderStats = stats; }
+    void setGpuStatus(bool supported, bool emulated) { gpuSupported = supported; gpuEmulated = emulated; }
+    void addGpuPass(GpuPass pass, float ms) { gpuTimes[pass].add(ms); }
+
+    // Gọi giữa ImGui::NewFrame và ImGui::Render
+    void draw(const MatchSimulation& sim, const TextureManager& textures) const;
+
+private:
+    bool visible = false;
+    PerfSeries frameTimes;
+    PerfSeries tickTimes;
+    PerfSeries allocations;
+    PerfSeries gpuTimes[GPU_PASS_COUNT];
+    PerfRenderStats renderStats;
+    bool gpuSupported = false;
+    bool gpuEmulated = false;
+};
+
+#endif // PERF_HUD_HPP
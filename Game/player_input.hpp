@@ -0,0 +1,31 @@
+﻿#ifndef PLAYER_INPUT_HPP
+#define PLAYER_INPUT_HPP
+
+#include <cstdint>
+
+// Trạng thái nút của một người chơi trong một tick
+struct PlayerInput {
+    enum Button : uint8_t {
+        LEFT = 1 << 0,
+        RIGHT = 1 << 1,
+        UP = 1 << 2,
+        DOWN = 1 << 3,
+        ATTACK = 1 << 4,
+        SKILL = 1 << 5,
+        DODGE = 1 << 6
+    };
+
+    uint8_t held = 0;     // Nút đang giữ ở tick này
+    uint8_t previous = 0; // Nút đang giữ ở tick trước
+
+    bool isDown(Button b) const { return (held & b) != 0; }
+    bool isPressed(Button b) const { return (held & b) != 0 && (previous & b) == 0; }
+    bool isReleased(Button b) const { return (held & b) == 0 && (previous & b) != 0; }
+};
+
+// Input của cả trận cho một tick: buttons[0] là Player 1, buttons[1] là Player 2
+struct MatchInput {
+    uint8_t buttons[2] = { 0, 0 };
+};
+
+#endif // PLAYER_INPUT_HPP
@@ -0,0 +1,114 @@
+﻿#include "profiler.hpp"
+#include "json.hpp"
+#include <chrono>
+#include <fstream>
+
+static thread_local const char* localThreadName = nullptr;
+
+Profiler& Profiler::instance() {
+    static Profiler profiler;
+    return profiler;
+}
+
+Profiler::Profiler() : enabled(false), buffers(nullptr), nextThreadId(1), dropped(0) {
+    nowNanos();
+}
+
+Profiler::~Profiler() {
+    ThreadBuffer* buffer = buffers.load(std::memory_order_acquire);
+    while (buffer) {
+        ThreadBuffer* next = buffer->next;
+        delete buffer;
+        buffer = next;
+    }
+}
+
+int64_t Profiler::nowNanos() {
+    static const auto start = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+void Profiler::setThreadName(const char* name) {
+    localThreadName = name;
+}
+
+Profiler::ThreadBuffer* Profiler::threadBuffer() {
+    static thread_local ThreadBuffer* localBuffer = nullptr;
+    if (!localBuffer) {
+        ThreadBuffer* buffer = new ThreadBuffer();
+        buffer->count.store(0, std::memory_order_relaxed);
+        buffer->threadId = nextThreadId.fetch_add(1, std::memory_order_relaxed);
+        buffer->name = localThreadName;
+        buffer->next = buffers.load(std::memory_order_relaxed);
+        while (!buffers.compare_exchange_weak(buffer->next, buffer, std::memory_order_release, std::memory_order_relaxed)) {
+        }
+        localBuffer = buffer;
+    }
+    return localBuffer;
+}
+
+void Profiler::push(const ProfileEvent& event) {
+    ThreadBuffer* buffer = threadBuffer();
+    size_t index = buffer->count.load(std::memory_order_relaxed);
+    if (index >= PROFILE_EVENTS_PER_THREAD) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    buffer->events[index] = event;
+    buffer->count.store(index + 1, std::memory_order_release);
+}
+
+void Profiler::record(const char* name, int64_t startNanos, int64_t endNanos) {
+    push(ProfileEvent{ name, startNanos, endNanos, 0.0, false });
+}
+
+void Profiler::recordCounter(const char* name, double value) {
+    if (!isEnabled()) return;
+    int64_t now = nowNanos();
+    push(ProfileEvent{ name, now, now, value, true });
+}
+
+void Profiler::clear() {
+    for (ThreadBuffer* buffer = buffers.load(std::memory_order_acquire); buffer; buffer = buffer->next) {
+        buffer->count.store(0, std::memory_order_relaxed);
+    }
+    dropped.store(0, std::memory_order_relaxed);
+}
+
+size_t Profiler::eventCount() const {
+    size_t total = 0;
+    for (ThreadBuffer* buffer = buffers.load(std::memory_order_acquire); buffer; buffer = buffer->next) {
+        total += buffer->count.load(std::memory_order_acquire);
+    }
+    return total;
+}
+
+bool Profiler::writeChromeTrace(const std::string& path) const {
+    // Zone là "complete event" (ph = X), counter là ph = C; thời gian tính bằng micro giây
+    nlohmann::json events = nlohmann::json::array();
+    for (ThreadBuffer* buffer = buffers.load(std::memory_order_acquire); buffer; buffer = buffer->next) {
+        if (buffer->name) {
+            events.push_back({ { "name", "thread_name" }, { "ph", "M" }, { "pid", 1 }, { "tid", buffer->threadId },
+                { "args", { { "name", buffer->name } } } });
+        }
+        size_t count = buffer->count.load(std::memory_order_acquire);
+        for (size_t i = 0; i < count; ++i) {
+            const ProfileEvent& event = buffer->events[i];
+            if (event.isCounter) {
+                events.push_back({ { "name", event.name }, { "ph", "C" }, { "pid", 1 }, { "tid", buffer->threadId },
+                    { "ts", event.startNanos / 1000.0 }, { "args", { { "value", event.value } } } });
+                continue;
+            }
+            events.push_back({ { "name", event.name }, { "ph", "X" }, { "pid", 1 }, { "tid", buffer->threadId },
+                { "ts", event.startNanos / 1000.0 }, { "dur", (event.endNanos - event.startNanos) / 1000.0 } });
+        }
+    }
+
+    std::ofstream file(path);
+    if (!file) return false;
+    nlohmann::json trace;
+    trace["traceEvents"] = std::move(events);
+    trace["displayTimeUnit"] = "ms";
+    file << trace.dump() << "\n";
+    return static_cast<bool>(file);
+}
@@ -0,0 +1,100 @@
+﻿#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Đặt PROFILER_ENABLED=0 để xóa hẳn mọi PROFILE_ZONE khi biên dịch
+#ifndef PROFILER_ENABLED
+#define PROFILER_ENABLED 1
+#endif
+
+const size_t PROFILE_EVENTS_PER_THREAD = 1 << 16; // Đầy thì bỏ zone mới và đếm lại
+
+struct ProfileEvent {
+    const char* name; // Phải là chuỗi hằng: chỉ được đọc lúc xuất trace
+    int64_t startNanos;
+    int64_t endNanos;
+    double value;     // Chỉ dùng cho counter
+    bool isCounter;   // Counter là một giá trị tại thời điểm startNanos, vẽ thành biểu đồ trong trace
+};
+
+// Profiler theo zone: mỗi thread ghi vào bộ đệm riêng của nó (một người ghi, không khóa),
+// bộ đệm được tạo lần đầu thread ghi khi profiler đang bật. Khi tắt, mỗi zone chỉ tốn
+// một lần đọc cờ. Kết quả xuất ra định dạng Chrome trace event để xem bằng
+// chrome://tracing hoặc Perfetto.
+class Profiler {
+public:
+    static Profiler& instance();
+
+    void setEnabled(bool on) { enabled.store(on, std::memory_order_relaxed); }
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+    // Tên hiện trong trace cho thread gọi hàm; name phải là chuỗi hằng
+    static void setThreadName(const char* name);
+
+    void record(const char* name, int64_t startNanos, int64_t endNanos);
+    // Ghi giá trị của counter name tại thời điểm hiện tại (ví dụ thời gian GPU của một pass)
+    void recordCounter(const char* name, double value);
+    // Bỏ mọi zone đã ghi; chỉ gọi khi không thread nào đang ghi (ví dụ sau setEnabled(false))
+    void clear();
+    // Ghi mọi zone đã thu thập ra file JSON, false nếu không mở được file
+    bool writeChromeTrace(const std::string& path) const;
+
+    size_t eventCount() const;
+    uint64_t droppedCount() const { return dropped.load(std::memory_order_relaxed); }
+
+    // Nano giây kể từ lúc chương trình bắt đầu, theo steady_clock
+    static int64_t nowNanos();
+
+private:
+    Profiler();
+    ~Profiler();
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    struct ThreadBuffer {
+        ProfileEvent events[PROFILE_EVENTS_PER_THREAD];
+        std::atomic<size_t> count; // Người ghi tăng sau khi ghi xong event, người đọc chỉ đọc [0, count)
+        uint32_t threadId;
+        const char* name;
+        ThreadBuffer* next;
+    };
+
+    ThreadBuffer* threadBuffer();
+    void push(const ProfileEvent& event);
+
+    std::atomic<bool> enabled;
+    std::atomic<ThreadBuffer*> buffers; // Danh sách liên kết, chỉ thêm vào đầu bằng CAS
+    std::atomic<uint32_t> nextThreadId;
+    std::atomic<uint64_t> dropped;
+};
+
+// Đo thời gian từ lúc tạo đến lúc hủy; dùng qua PROFILE_ZONE
+class ProfileZone {
+public:
+    explicit ProfileZone(const char* name)
+        : name(name), startNanos(Profiler::instance().isEnabled() ? Profiler::nowNanos() : -1) {}
+    ~ProfileZone() {
+        if (startNanos >= 0) Profiler::instance().record(name, startNanos, Profiler::nowNanos());
+    }
+
+private:
+    const char* name;
+    int64_t startNanos;
+
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#if PROFILER_ENABLED
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#else
+#define PROFILE_ZONE(name) ((void)0)
+#endif
+
+#endif // PROFILER_HPP
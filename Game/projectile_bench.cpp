@@ -0,0 +1,119 @@
+﻿#include "projectile_kernel.hpp"
+#include "game_config.hpp"
+#include "rng.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// Đo tốc độ các kernel cập nhật mũi tên ở 1k/10k/100k mũi tên.
+// Ví dụ: projectile_bench --targets 2 --iterations 2000
+
+struct BenchState {
+    std::vector<float> x, y, prevX, prevY, velocityX, velocityY;
+    std::vector<uint8_t> active, hitMask;
+
+    explicit BenchState(int count)
+        : x(count), y(count), prevX(count), prevY(count), velocityX(count), velocityY(count),
+        active(count), hitMask(count) {
+    }
+
+    ProjectileArrays arrays() {
+        return { x.data(), y.data(), prevX.data(), prevY.data(), velocityX.data(), velocityY.data(),
+            active.data(), hitMask.data() };
+    }
+};
+
+// Mũi tên bay qua lại giữa màn hình với vận tốc nhỏ để phần lớn vẫn còn sống khi đo
+static void fillState(BenchState& state, uint32_t seed) {
+    MatchRng rng;
+    rng.seed(seed);
+    for (size_t i = 0; i < state.x.size(); ++i) {
+        state.x[i] = static_cast<float>(rng.nextBelow(static_cast<uint32_t>(WINDOW_WIDTH)));
+        state.y[i] = static_cast<float>(rng.nextBelow(static_cast<uint32_t>(WINDOW_HEIGHT)));
+        state.velocityX[i] = (static_cast<float>(rng.nextBelow(2001)) - 1000.0f) / 10000.0f;
+        state.velocityY[i] = (static_cast<float>(rng.nextBelow(2001)) - 1000.0f) / 10000.0f;
+        state.active[i] = rng.nextBelow(16) != 0;
+        state.hitMask[i] = 0;
+    }
+}
+
+static std::vector<ProjectileTarget> makeTargets(int count) {
+    std::vector<ProjectileTarget> targets;
+    for (int t = 0; t < count; ++t) {
+        float left = 100.0f + t * (WINDOW_WIDTH - 600.0f) / (count > 1 ? count - 1 : 1);
+        targets.push_back({ left, left + 400.0f, 400.0f, 480.0f });
+    }
+    return targets;
+}
+
+static bool sameResult(const BenchState& a, const BenchState& b) {
+    size_t n = a.x.size();
+    return std::memcmp(a.x.data(), b.x.data(), n * sizeof(float)) == 0 &&
+        std::memcmp(a.y.data(), b.y.data(), n * sizeof(float)) == 0 &&
+        std::memcmp(a.prevX.data(), b.prevX.data(), n * sizeof(float)) == 0 &&
+        std::memcmp(a.velocityY.data(), b.velocityY.data(), n * sizeof(float)) == 0 &&
+        a.active == b.active && a.hitMask == b.hitMask;
+}
+
+int main(int argc, char** argv) {
+    int targetCount = 2;
+    long long budget = 200000000; // Tổng số lượt cập nhật mũi tên cho mỗi kích thước
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--targets") == 0 && i + 1 < argc) {
+            targetCount = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--updates") == 0 && i + 1 < argc) {
+            budget = std::atoll(argv[++i]);
+        }
+        else {
+            std::fprintf(stderr, "Usage: projectile_bench [--targets N (1-%d)] [--updates N]\n", MAX_PROJECTILE_TARGETS);
+            return 1;
+        }
+    }
+    if (targetCount < 1 || targetCount > MAX_PROJECTILE_TARGETS) targetCount = 2;
+    std::vector<ProjectileTarget> targets = makeTargets(targetCount);
+
+    const int SIZES[] = { 1000, 10000, 100000 };
+    std::printf("%d target(s), best kernel on this CPU: %s\n", targetCount, projectileKernelName(bestProjectileKernel()));
+    std::printf("%10s %8s %12s %10s\n", "count", "kernel", "ns/arrow", "speedup");
+    for (int count : SIZES) {
+        int iterations = static_cast<int>(budget / count);
+        if (iterations < 1) iterations = 1;
+
+        // Chạy một tick trên mọi kernel từ cùng trạng thái để chắc chắn kết quả khớp
+        BenchState reference(count);
+        fillState(reference, 7);
+        integrateProjectiles(KERNEL_SCALAR, reference.arrays(), count, targets.data(), targetCount);
+
+        double scalarTime = 0.0;
+        for (int k = 0; k < KERNEL_COUNT; ++k) {
+            ProjectileKernel kernel = static_cast<ProjectileKernel>(k);
+            if (!isProjectileKernelSupported(kernel)) continue;
+
+            BenchState state(count);
+            fillState(state, 7);
+            integrateProjectiles(kernel, state.arrays(), count, targets.data(), targetCount);
+            if (!sameResult(reference, state)) {
+                std::printf("%10d %8s   MISMATCH with scalar kernel\n", count, projectileKernelName(kernel));
+                return 1;
+            }
+
+            ProjectileArrays arrays = state.arrays();
+            auto start = std::chrono::steady_clock::now();
+            for (int it = 0; it < iterations; ++it) {
+                integrateProjectiles(kernel, arrays, count, targets.data(), targetCount);
+            }
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            if (kernel == KERNEL_SCALAR) scalarTime = seconds;
+
+            // Dùng kết quả để compiler không bỏ vòng đo
+            volatile uint8_t sink = state.hitMask[count / 2];
+            (void)sink;
+            std::printf("%10d %8s %12.3f %9.2fx\n", count, projectileKernelName(kernel),
+                seconds * 1e9 / (static_cast<double>(iterations) * count), scalarTime / seconds);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,269 @@
+﻿#include "projectile_kernel.hpp"
+#include "game_config.hpp"
+#include <cmath>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define PROJECTILE_KERNEL_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define TARGET_AVX2
+#else
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+// Vùng trúng dạng tâm + nửa kích thước, tính một lần cho mọi kernel
+struct TargetBox {
+    float centerX, centerY;
+    float extentX, extentY;
+};
+
+static void toTargetBoxes(const ProjectileTarget* targets, int targetCount, TargetBox* boxes) {
+    for (int t = 0; t < targetCount; ++t) {
+        boxes[t].centerX = (targets[t].minX + targets[t].maxX) * 0.5f;
+        boxes[t].centerY = (targets[t].minY + targets[t].maxY) * 0.5f;
+        boxes[t].extentX = (targets[t].maxX - targets[t].minX) * 0.5f;
+        boxes[t].extentY = (targets[t].maxY - targets[t].minY) * 0.5f;
+    }
+}
+
+// Đoạn (tâm m, nửa vectơ h) cắt hộp (tâm c, nửa kích thước e) khi không có trục tách nào:
+// hai trục x, y và pháp tuyến của đoạn. Không chia nên không sinh NaN khi đoạn song song trục,
+// và chạm cạnh vẫn tính là trúng như phép thử điểm cũ.
+// Dùng cho phần dư cuối mảng và cho CPU không có SIMD
+static void integrateScalar(const ProjectileArrays& a, int begin, int end,
+    const TargetBox* boxes, int targetCount) {
+    for (int i = begin; i < end; ++i) {
+        float prevX = a.x[i];
+        float prevY = a.y[i];
+        a.prevX[i] = prevX;
+        a.prevY[i] = prevY;
+        float x = prevX + a.velocityX[i];
+        float velocityY = a.velocityY[i] + GRAVITY;
+        float y = prevY + velocityY;
+        a.x[i] = x;
+        a.y[i] = y;
+        a.velocityY[i] = velocityY;
+        uint8_t wasActive = a.active[i];
+        a.active[i] = wasActive & static_cast<uint8_t>((x >= 0.0f) & (x <= WINDOW_WIDTH) & (y >= 0.0f) & (y <= WINDOW_HEIGHT));
+
+        float midX = (prevX + x) * 0.5f;
+        float midY = (prevY + y) * 0.5f;
+        float halfX = (x - prevX) * 0.5f;
+        float halfY = (y - prevY) * 0.5f;
+        float absHalfX = std::fabs(halfX);
+        float absHalfY = std::fabs(halfY);
+        uint8_t mask = 0;
+        for (int t = 0; t < targetCount; ++t) {
+            const TargetBox& box = boxes[t];
+            float offsetX = midX - box.centerX;
+            float offsetY = midY - box.centerY;
+            bool hit = (std::fabs(offsetX) <= box.extentX + absHalfX) &
+                (std::fabs(offsetY) <= box.extentY + absHalfY) &
+                (std::fabs(halfX * offsetY - halfY * offsetX) <= box.extentX * absHalfY + box.extentY * absHalfX);
+            mask |= static_cast<uint8_t>(hit) << t;
+        }
+        a.hitMask[i] = wasActive ? mask : 0;
+    }
+}
+
+#ifdef PROJECTILE_KERNEL_X86
+
+// EXPAND_BITS[m] có byte j bằng 1 nếu bit j của m bật, để áp mặt nạ SIMD lên 8 byte active một lần
+struct ExpandTable {
+    uint64_t bits[256];
+    ExpandTable() {
+        for (int m = 0; m < 256; ++m) {
+            uint64_t value = 0;
+            for (int j = 0; j < 8; ++j) {
+                if (m & (1 << j)) value |= uint64_t(1) << (j * 8);
+            }
+            bits[m] = value;
+        }
+    }
+};
+static const ExpandTable EXPAND_BITS;
+
+static void integrateSse2(const ProjectileArrays& a, int count, const TargetBox* boxes, int targetCount) {
+    const __m128 gravity = _mm_set1_ps(GRAVITY);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 width = _mm_set1_ps(WINDOW_WIDTH);
+    const __m128 height = _mm_set1_ps(WINDOW_HEIGHT);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 prevX = _mm_loadu_ps(a.x + i);
+        __m128 prevY = _mm_loadu_ps(a.y + i);
+        _mm_storeu_ps(a.prevX + i, prevX);
+        _mm_storeu_ps(a.prevY + i, prevY);
+        __m128 velocityY = _mm_add_ps(_mm_loadu_ps(a.velocityY + i), gravity);
+        __m128 x = _mm_add_ps(prevX, _mm_loadu_ps(a.velocityX + i));
+        __m128 y = _mm_add_ps(prevY, velocityY);
+        _mm_storeu_ps(a.x + i, x);
+        _mm_storeu_ps(a.y + i, y);
+        _mm_storeu_ps(a.velocityY + i, velocityY);
+
+        __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(x, zero), _mm_cmple_ps(x, width)),
+            _mm_and_ps(_mm_cmpge_ps(y, zero), _mm_cmple_ps(y, height)));
+        uint32_t wasActive;
+        std::memcpy(&wasActive, a.active + i, 4);
+        uint32_t active = wasActive & static_cast<uint32_t>(EXPAND_BITS.bits[_mm_movemask_ps(inside)]);
+        std::memcpy(a.active + i, &active, 4);
+
+        __m128 midX = _mm_mul_ps(_mm_add_ps(prevX, x), half);
+        __m128 midY = _mm_mul_ps(_mm_add_ps(prevY, y), half);
+        __m128 halfX = _mm_mul_ps(_mm_sub_ps(x, prevX), half);
+        __m128 halfY = _mm_mul_ps(_mm_sub_ps(y, prevY), half);
+        __m128 absHalfX = _mm_and_ps(halfX, absMask);
+        __m128 absHalfY = _mm_and_ps(halfY, absMask);
+
+        // Mỗi mục tiêu cho một movemask 4 bit; ghép thành byte hitMask của từng mũi tên
+        uint32_t hits = 0;
+        for (int t = 0; t < targetCount; ++t) {
+            const TargetBox& box = boxes[t];
+            __m128 extentX = _mm_set1_ps(box.extentX);
+            __m128 extentY = _mm_set1_ps(box.extentY);
+            __m128 offsetX = _mm_sub_ps(midX, _mm_set1_ps(box.centerX));
+            __m128 offsetY = _mm_sub_ps(midY, _mm_set1_ps(box.centerY));
+            __m128 cross = _mm_sub_ps(_mm_mul_ps(halfX, offsetY), _mm_mul_ps(halfY, offsetX));
+            __m128 hit = _mm_and_ps(
+                _mm_and_ps(_mm_cmple_ps(_mm_and_ps(offsetX, absMask), _mm_add_ps(extentX, absHalfX)),
+                    _mm_cmple_ps(_mm_and_ps(offsetY, absMask), _mm_add_ps(extentY, absHalfY))),
+                _mm_cmple_ps(_mm_and_ps(cross, absMask),
+                    _mm_add_ps(_mm_mul_ps(extentX, absHalfY), _mm_mul_ps(extentY, absHalfX))));
+            hits |= static_cast<uint32_t>(EXPAND_BITS.bits[_mm_movemask_ps(hit)]) << t;
+        }
+        // wasActive là 0/1 trên từng byte nên nhân với 0xFF để được mặt nạ byte
+        hits &= wasActive * 0xFFu;
+        std::memcpy(a.hitMask + i, &hits, 4);
+    }
+    integrateScalar(a, i, count, boxes, targetCount);
+}
+
+TARGET_AVX2 static void integrateAvx2(const ProjectileArrays& a, int count, const TargetBox* boxes, int targetCount) {
+    const __m256 gravity = _mm256_set1_ps(GRAVITY);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 width = _mm256_set1_ps(WINDOW_WIDTH);
+    const __m256 height = _mm256_set1_ps(WINDOW_HEIGHT);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 prevX = _mm256_loadu_ps(a.x + i);
+        __m256 prevY = _mm256_loadu_ps(a.y + i);
+        _mm256_storeu_ps(a.prevX + i, prevX);
+        _mm256_storeu_ps(a.prevY + i, prevY);
+        __m256 velocityY = _mm256_add_ps(_mm256_loadu_ps(a.velocityY + i), gravity);
+        __m256 x = _mm256_add_ps(prevX, _mm256_loadu_ps(a.velocityX + i));
+        __m256 y = _mm256_add_ps(prevY, velocityY);
+        _mm256_storeu_ps(a.x + i, x);
+        _mm256_storeu_ps(a.y + i, y);
+        _mm256_storeu_ps(a.velocityY + i, velocityY);
+
+        __m256 inside = _mm256_and_ps(
+            _mm256_and_ps(_mm256_cmp_ps(x, zero, _CMP_GE_OQ), _mm256_cmp_ps(x, width, _CMP_LE_OQ)),
+            _mm256_and_ps(_mm256_cmp_ps(y, zero, _CMP_GE_OQ), _mm256_cmp_ps(y, height, _CMP_LE_OQ)));
+        uint64_t wasActive;
+        std::memcpy(&wasActive, a.active + i, 8);
+        uint64_t active = wasActive & EXPAND_BITS.bits[_mm256_movemask_ps(inside)];
+        std::memcpy(a.active + i, &active, 8);
+
+        __m256 midX = _mm256_mul_ps(_mm256_add_ps(prevX, x), half);
+        __m256 midY = _mm256_mul_ps(_mm256_add_ps(prevY, y), half);
+        __m256 halfX = _mm256_mul_ps(_mm256_sub_ps(x, prevX), half);
+        __m256 halfY = _mm256_mul_ps(_mm256_sub_ps(y, prevY), half);
+        __m256 absHalfX = _mm256_and_ps(halfX, absMask);
+        __m256 absHalfY = _mm256_and_ps(halfY, absMask);
+
+        uint64_t hits = 0;
+        for (int t = 0; t < targetCount; ++t) {
+            const TargetBox& box = boxes[t];
+            __m256 extentX = _mm256_set1_ps(box.extentX);
+            __m256 extentY = _mm256_set1_ps(box.extentY);
+            __m256 offsetX = _mm256_sub_ps(midX, _mm256_set1_ps(box.centerX));
+            __m256 offsetY = _mm256_sub_ps(midY, _mm256_set1_ps(box.centerY));
+            __m256 cross = _mm256_sub_ps(_mm256_mul_ps(halfX, offsetY), _mm256_mul_ps(halfY, offsetX));
+            __m256 hit = _mm256_and_ps(
+                _mm256_and_ps(_mm256_cmp_ps(_mm256_and_ps(offsetX, absMask), _mm256_add_ps(extentX, absHalfX), _CMP_LE_OQ),
+                    _mm256_cmp_ps(_mm256_and_ps(offsetY, absMask), _mm256_add_ps(extentY, absHalfY), _CMP_LE_OQ)),
+                _mm256_cmp_ps(_mm256_and_ps(cross, absMask),
+                    _mm256_add_ps(_mm256_mul_ps(extentX, absHalfY), _mm256_mul_ps(extentY, absHalfX)), _CMP_LE_OQ));
+            hits |= EXPAND_BITS.bits[_mm256_movemask_ps(hit)] << t;
+        }
+        hits &= wasActive * 0xFFu;
+        std::memcpy(a.hitMask + i, &hits, 8);
+    }
+    integrateScalar(a, i, count, boxes, targetCount);
+}
+
+static bool cpuHasAvx2() {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx) return false;
+    // Hệ điều hành phải lưu thanh ghi YMM khi chuyển ngữ cảnh
+    if ((_xgetbv(0) & 0x6) != 0x6) return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif // PROJECTILE_KERNEL_X86
+
+bool isProjectileKernelSupported(ProjectileKernel kernel) {
+    switch (kernel) {
+    case KERNEL_SCALAR: return true;
+#ifdef PROJECTILE_KERNEL_X86
+    case KERNEL_SSE2: return true;
+    case KERNEL_AVX2: {
+        static const bool supported = cpuHasAvx2();
+        return supported;
+    }
+#endif
+    default: return false;
+    }
+}
+
+ProjectileKernel bestProjectileKernel() {
+    static const ProjectileKernel best =
+        isProjectileKernelSupported(KERNEL_AVX2) ? KERNEL_AVX2 :
+        isProjectileKernelSupported(KERNEL_SSE2) ? KERNEL_SSE2 : KERNEL_SCALAR;
+    return best;
+}
+
+const char* projectileKernelName(ProjectileKernel kernel) {
+    switch (kernel) {
+    case KERNEL_SCALAR: return "scalar";
+    case KERNEL_SSE2: return "sse2";
+    case KERNEL_AVX2: return "avx2";
+    default: return "unknown";
+    }
+}
+
+void integrateProjectiles(ProjectileKernel kernel, const ProjectileArrays& arrays, int count,
+    const ProjectileTarget* targets, int targetCount) {
+    if (targetCount > MAX_PROJECTILE_TARGETS) targetCount = MAX_PROJECTILE_TARGETS;
+    TargetBox boxes[MAX_PROJECTILE_TARGETS];
+    toTargetBoxes(targets, targetCount, boxes);
+#ifdef PROJECTILE_KERNEL_X86
+    if (kernel == KERNEL_AVX2 && isProjectileKernelSupported(KERNEL_AVX2)) {
+        integrateAvx2(arrays, count, boxes, targetCount);
+        return;
+    }
+    if (kernel == KERNEL_SSE2) {
+        integrateSse2(arrays, count, boxes, targetCount);
+        return;
+    }
+#endif
+    integrateScalar(arrays, 0, count, boxes, targetCount);
+}
@@ -0,0 +1,44 @@
+﻿#ifndef PROJECTILE_KERNEL_HPP
+#define PROJECTILE_KERNEL_HPP
+
+#include <cstdint>
+
+// Vùng trúng của một mục tiêu (dải 40%-60% chiều cao của nhân vật)
+struct ProjectileTarget {
+    float minX, maxX;
+    float minY, maxY;
+};
+
+const int MAX_PROJECTILE_TARGETS = 8; // Mỗi mục tiêu là một bit trong hitMask
+
+// Các mảng SoA mà kernel đọc/ghi, dùng chung cho ProjectilePool và benchmark
+struct ProjectileArrays {
+    float* x;
+    float* y;
+    float* prevX;
+    float* prevY;
+    float* velocityX;
+    float* velocityY;
+    uint8_t* active;
+    uint8_t* hitMask;
+};
+
+enum ProjectileKernel {
+    KERNEL_SCALAR,
+    KERNEL_SSE2,
+    KERNEL_AVX2,
+    KERNEL_COUNT
+};
+
+// Trong một lượt: lưu vị trí cũ, cộng trọng lực và vận tốc, tắt mũi tên ra khỏi màn hình,
+// rồi ghi vào hitMask[i] bit t nếu đoạn đường mũi tên i (còn sống đầu lượt) đi trong lượt này
+// cắt vùng trúng của targets[t]. Kiểm tra theo đoạn nên mũi tên nhanh không xuyên qua mục tiêu.
+// Mọi kernel cho kết quả giống hệt nhau từng bit.
+void integrateProjectiles(ProjectileKernel kernel, const ProjectileArrays& arrays, int count,
+    const ProjectileTarget* targets, int targetCount);
+// Kernel nhanh nhất mà CPU đang chạy hỗ trợ (kiểm tra một lần)
+ProjectileKernel bestProjectileKernel();
+bool isProjectileKernelSupported(ProjectileKernel kernel);
+const char* projectileKernelName(ProjectileKernel kernel);
+
+#endif // PROJECTILE_KERNEL_HPP
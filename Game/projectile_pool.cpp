@@ -0,0 +1,46 @@
+﻿#include "projectile_pool.hpp"
+
+ProjectilePool::ProjectilePool() : count(0) {
+}
+
+int ProjectilePool::spawn(float startX, float startY, float dirX, float dirY, float dmg, Color col,
+    DamageSource src, bool willHit, int ownerIndex) {
+    if (count >= MAX_PROJECTILES) return -1;
+    int i = count++;
+    x[i] = startX;
+    y[i] = startY;
+    prevX[i] = startX;
+    prevY[i] = startY;
+    velocityX[i] = dirX * PROJECTILE_SPEED;
+    velocityY[i] = dirY * PROJECTILE_SPEED;
+    damage[i] = dmg;
+    active[i] = 1;
+    owner[i] = static_cast<uint8_t>(ownerIndex);
+    source[i] = static_cast<uint8_t>(src);
+    hits[i] = willHit ? 1 : 0;
+    color[i] = col;
+    return i;
+}
+
+void ProjectilePool::despawn(int index) {
+    int last = --count;
+    if (index == last) return;
+    x[index] = x[last];
+    y[index] = y[last];
+    prevX[index] = prevX[last];
+    prevY[index] = prevY[last];
+    velocityX[index] = velocityX[last];
+    velocityY[index] = velocityY[last];
+    damage[index] = damage[last];
+    active[index] = active[last];
+    owner[index] = owner[last];
+    source[index] = source[last];
+    hits[index] = hits[last];
+    color[index] = color[last];
+    hitMask[index] = hitMask[last];
+}
+
+void ProjectilePool::update(const ProjectileTarget* targets, int targetCount) {
+    ProjectileArrays arrays = { x, y, prevX, prevY, velocityX, velocityY, active, hitMask };
+    integrateProjectiles(bestProjectileKernel(), arrays, count, targets, targetCount);
+}
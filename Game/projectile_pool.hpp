@@ -0,0 +1,46 @@
+﻿#ifndef PROJECTILE_POOL_HPP
+#define PROJECTILE_POOL_HPP
+
+#include "components.hpp"
+#include "projectile_kernel.hpp"
+#include <cstdint>
+
+const int MAX_PROJECTILES = 1024;
+const float PROJECTILE_SPEED = 5.0f; // Tốc độ mũi tên khi hướng bắn có độ dài 1
+
+// Mọi mũi tên của một trận, lưu theo dạng SoA: mỗi thuộc tính là một mảng liền nhau
+// nên vòng cập nhật chỉ chạm vào dữ liệu nóng và compiler vector hóa được.
+// Các mũi tên còn sống luôn nằm ở [0, count); xóa bằng cách đưa phần tử cuối vào chỗ trống.
+class ProjectilePool {
+public:
+    ProjectilePool();
+
+    // Bắn mũi tên theo hướng (dirX, dirY) nhân PROJECTILE_SPEED. Trả về -1 nếu pool đã đầy
+    int spawn(float startX, float startY, float dirX, float dirY, float damage, Color color,
+        DamageSource source, bool hits, int owner);
+    // Xóa mũi tên index; mũi tên cuối được chuyển vào vị trí này
+    void despawn(int index);
+    // Di chuyển mọi mũi tên một tick, tắt những mũi tên đã ra khỏi màn hình và
+    // ghi hitMask so với các mục tiêu (dùng kernel SIMD tốt nhất của CPU)
+    void update(const ProjectileTarget* targets = nullptr, int targetCount = 0);
+    void clear() { count = 0; }
+    int size() const { return count; }
+
+    // Dữ liệu nóng, dùng mỗi tick
+    alignas(32) float x[MAX_PROJECTILES];
+    alignas(32) float y[MAX_PROJECTILES];
+    alignas(32) float velocityX[MAX_PROJECTILES];
+    alignas(32) float velocityY[MAX_PROJECTILES];
+    alignas(32) float damage[MAX_PROJECTILES];
+    alignas(32) uint8_t active[MAX_PROJECTILES];
+    // Dữ liệu lạnh, chỉ dùng khi trúng đích hoặc khi vẽ
+    float prevX[MAX_PROJECTILES], prevY[MAX_PROJECTILES];
+    uint8_t owner[MAX_PROJECTILES];  // Chỉ số người bắn trong trận
+    uint8_t source[MAX_PROJECTILES]; // DamageSource
+    uint8_t hits[MAX_PROJECTILES];   // Kết quả tung trúng/trượt, quyết định ngay khi bắn
+    Color color[MAX_PROJECTILES];
+    uint8_t hitMask[MAX_PROJECTILES]; // Kết quả của update(): bit t bật nếu trúng targets[t]
+    int count;
+};
+
+#endif // PROJECTILE_POOL_HPP
@@ -0,0 +1,177 @@
+﻿#include "replay.hpp"
+#include <cstring>
+#include <fstream>
+
+static const char REPLAY_MAGIC[4] = { 'L', 'Q', 'R', 'P' };
+static const uint8_t REPLAY_VERSION = 1;
+static const size_t REPLAY_RESERVED_RUNS = 4096; // Vài phút với input đổi liên tục
+
+void Replay::begin(const MatchSimulation& sim) {
+    seed = sim.state.seed;
+    p1Type = sim.state.p1Type;
+    p2Type = sim.state.p2Type;
+    tickCount = 0;
+    runs.clear();
+    runs.reserve(REPLAY_RESERVED_RUNS);
+    resultHash = 0;
+}
+
+void Replay::record(const MatchInput& input) {
+    ++tickCount;
+    if (!runs.empty()) {
+        ReplayRun& last = runs.back();
+        if (last.buttons[0] == input.buttons[0] && last.buttons[1] == input.buttons[1]) {
+            ++last.length;
+            return;
+        }
+    }
+    runs.push_back(ReplayRun{ 1, { input.buttons[0], input.buttons[1] } });
+}
+
+void Replay::finish(const MatchSimulation& sim) {
+    resultHash = replayResultHash(sim);
+}
+
+bool Replay::finishIfEnded(const MatchSimulation& sim) {
+    if (sim.isRunning()) return false;
+    finish(sim);
+    return true;
+}
+
+// FNV-1a 32 bit
+static void hashBytes(uint32_t& hash, const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+}
+
+uint32_t replayResultHash(const MatchSimulation& sim) {
+    uint32_t hash = 2166136261u;
+    hashBytes(hash, &sim.state.tick, sizeof(sim.state.tick));
+    if (!sim.hasPlayers()) return hash;
+    for (int player = 0; player < 2; ++player) {
+        const Health& health = sim.health(player);
+        hashBytes(hash, &health.health, sizeof(health.health));
+        hashBytes(hash, &health.maxHealth, sizeof(health.maxHealth));
+        hashBytes(hash, sim.fighter(player).damageDealt, sizeof(sim.fighter(player).damageDealt));
+    }
+    return hash;
+}
+
+static void writeVarint(std::vector<uint8_t>& out, uint32_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+static bool readVarint(const uint8_t*& data, const uint8_t* end, uint32_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (data == end) return false;
+        uint8_t byte = *data++;
+        value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+void encodeReplay(const Replay& replay, std::vector<uint8_t>& out) {
+    out.clear();
+    out.reserve(32 + replay.runs.size() * 4);
+    out.insert(out.end(), REPLAY_MAGIC, REPLAY_MAGIC + 4);
+    out.push_back(REPLAY_VERSION);
+    out.push_back(static_cast<uint8_t>(replay.p1Type));
+    out.push_back(static_cast<uint8_t>(replay.p2Type));
+    writeVarint(out, replay.seed);
+    writeVarint(out, replay.tickCount);
+    writeVarint(out, static_cast<uint32_t>(replay.runs.size()));
+    for (const ReplayRun& run : replay.runs) {
+        writeVarint(out, run.length);
+        out.push_back(run.buttons[0]);
+        out.push_back(run.buttons[1]);
+    }
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<uint8_t>(replay.resultHash >> (8 * i)));
+    }
+}
+
+bool decodeReplay(const uint8_t* data, size_t size, Replay& replay) {
+    const uint8_t* end = data + size;
+    if (size < 7 || std::memcmp(data, REPLAY_MAGIC, 4) != 0 || data[4] != REPLAY_VERSION) return false;
+    if (data[5] > DAU_SI || data[6] > DAU_SI) return false;
+    replay.p1Type = static_cast<CharacterType>(data[5]);
+    replay.p2Type = static_cast<CharacterType>(data[6]);
+    data += 7;
+
+    uint32_t runCount;
+    if (!readVarint(data, end, replay.seed) || !readVarint(data, end, replay.tickCount) ||
+        !readVarint(data, end, runCount)) {
+        return false;
+    }
+    // Mỗi đoạn chiếm ít nhất 3 byte: chặn số đoạn vô lý trước khi cấp phát
+    if (runCount > static_cast<size_t>(end - data) / 3) return false;
+    replay.runs.resize(runCount);
+    uint64_t ticks = 0;
+    for (ReplayRun& run : replay.runs) {
+        if (!readVarint(data, end, run.length) || run.length == 0 || end - data < 2) return false;
+        run.buttons[0] = *data++;
+        run.buttons[1] = *data++;
+        ticks += run.length;
+    }
+    if (ticks != replay.tickCount || end - data != 4) return false;
+    replay.resultHash = static_cast<uint32_t>(data[0]) | (static_cast<uint32_t>(data[1]) << 8) |
+        (static_cast<uint32_t>(data[2]) << 16) | (static_cast<uint32_t>(data[3]) << 24);
+    return true;
+}
+
+bool saveReplay(const std::string& path, const Replay& replay) {
+    std::vector<uint8_t> bytes;
+    encodeReplay(replay, bytes);
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    return static_cast<bool>(file);
+}
+
+bool loadReplay(const std::string& path, Replay& replay) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+    std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return decodeReplay(bytes.data(), bytes.size(), replay);
+}
+
+void ReplayPlayer::start(MatchSimulation& sim, const Replay& source) {
+    replay = &source;
+    run = 0;
+    offsetInRun = 0;
+    tick = 0;
+    accumulator = 0.0;
+    sim.start(source.p1Type, source.p2Type, source.seed);
+}
+
+int ReplayPlayer::ticksDue(double elapsedSeconds, float speed) {
+    if (speed <= 0.0f && !finished()) {
+        accumulator = 0.0;
+        return static_cast<int>(replay->tickCount - tick);
+    }
+    accumulator += elapsedSeconds * (speed > 0.0f ? speed : 1.0f);
+    int due = static_cast<int>(accumulator / TICK_DT);
+    accumulator -= due * TICK_DT;
+    return due;
+}
+
+MatchInput ReplayPlayer::nextInput() {
+    MatchInput input;
+    if (finished()) return input;
+    const ReplayRun& current = replay->runs[run];
+    input.buttons[0] = current.buttons[0];
+    input.buttons[1] = current.buttons[1];
+    ++tick;
+    if (++offsetInRun == current.length) {
+        ++run;
+        offsetInRun = 0;
+    }
+    return input;
+}
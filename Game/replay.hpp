@@ -0,0 +1,72 @@
+﻿#ifndef REPLAY_HPP
+#define REPLAY_HPP
+
+#include "match_simulation.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Một đoạn các tick liền nhau có cùng input của cả hai người chơi
+struct ReplayRun {
+    uint32_t length;
+    uint8_t buttons[2];
+};
+
+// Trận đấu ghi lại: MatchSimulation là xác định nên seed, hai tướng và input từng tick
+// là đủ để chạy lại y hệt. Input được gộp thành các đoạn không đổi (delta theo thời gian).
+struct Replay {
+    uint32_t seed = 0;
+    CharacterType p1Type = XA_THU;
+    CharacterType p2Type = XA_THU;
+    uint32_t tickCount = 0;
+    std::vector<ReplayRun> runs;
+    uint32_t resultHash = 0; // replayResultHash() lúc trận kết thúc, 0 nếu chưa có
+
+    // Bắt đầu ghi trận vừa start(); giữ sẵn chỗ để việc ghi trong trận hiếm khi cấp phát
+    void begin(const MatchSimulation& sim);
+    // Ghi input của tick sắp chạy; gọi trước sim.step(input)
+    void record(const MatchInput& input);
+    void finish(const MatchSimulation& sim);
+    // Gọi ngay sau sim.step() của tick vừa record(): nếu tick đó kết thúc trận thì finish() luôn và
+    // trả về true. Sim vẫn tăng state.tick ở các tick sau kết thúc, finish() muộn hơn sẽ sai hash
+    bool finishIfEnded(const MatchSimulation& sim);
+};
+
+// Hash của kết quả trận (tick, máu, sát thương gây ra) để kiểm tra lần chạy lại khớp với bản ghi
+uint32_t replayResultHash(const MatchSimulation& sim);
+
+// Định dạng file: "LQRP", phiên bản, hai tướng, rồi seed, số tick, số đoạn và từng đoạn
+// (độ dài, hai byte nút) dưới dạng varint LEB128, cuối cùng là resultHash 4 byte little-endian
+void encodeReplay(const Replay& replay, std::vector<uint8_t>& out);
+bool decodeReplay(const uint8_t* data, size_t size, Replay& replay);
+bool saveReplay(const std::string& path, const Replay& replay);
+bool loadReplay(const std::string& path, Replay& replay);
+
+// Phát lại một Replay qua MatchSimulation theo thời gian thực, nhanh/chậm hơn hoặc không giới hạn
+class ReplayPlayer {
+public:
+    // Khởi động sim với seed và tướng của replay; replay phải sống lâu hơn player
+    void start(MatchSimulation& sim, const Replay& replay);
+
+    // Số tick cần chạy cho elapsedSeconds thời gian thực. speed <= 0 là không giới hạn:
+    // trả về toàn bộ số tick còn lại, sau khi hết replay thì chạy theo thời gian thực
+    int ticksDue(double elapsedSeconds, float speed);
+    // Input của tick tiếp theo; rỗng khi đã hết replay
+    MatchInput nextInput();
+    // Phần đã trôi qua của tick hiện tại, để nội suy khi vẽ
+    float alpha() const { return static_cast<float>(accumulator / TICK_DT); }
+
+    bool finished() const { return !replay || tick >= replay->tickCount; }
+    uint32_t currentTick() const { return tick; }
+    uint32_t tickCount() const { return replay ? replay->tickCount : 0; }
+
+private:
+    const Replay* replay = nullptr;
+    size_t run = 0;
+    uint32_t offsetInRun = 0;
+    uint32_t tick = 0;
+    double accumulator = 0.0;
+};
+
+#endif // REPLAY_HPP
@@ -0,0 +1,166 @@
+﻿#include "replay.hpp"
+#include "match_bot.hpp"
+#include "thread_pool.hpp"
+#include "logger.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// Chạy lại các replay không giới hạn tốc độ và so kết quả với bản ghi.
+// Dùng để tái hiện lỗi và kiểm tra thay đổi cân bằng trên hàng nghìn trận đã ghi.
+// Ví dụ: replay_tool replays/            (mọi file .lqr trong thư mục)
+//        replay_tool --verbose last_match.lqr
+//        replay_tool --record-test 2      (ghi trận bot 2 tick mỗi frame như client 30 FPS rồi kiểm tra)
+
+enum ReplayOutcome { REPLAY_MATCHED, REPLAY_DIVERGED, REPLAY_UNREADABLE };
+
+struct ReplayCheck {
+    ReplayOutcome outcome = REPLAY_UNREADABLE;
+    uint32_t ticks = 0;
+    int winner = 0;
+    float health[2] = {};
+};
+
+static void printUsage() {
+    std::fprintf(stderr,
+        "Usage: replay_tool [options] FILE|DIR...\n"
+        "  --threads N        so thread, 0 = tat ca nhan CPU (mac dinh 0)\n"
+        "  --verbose          in ket qua tung replay\n"
+        "  --record-test N    ghi tran bot voi N tick moi frame nhu game, roi chay lai ban ghi\n");
+}
+
+static ReplayCheck runReplay(const Replay& replay) {
+    ReplayCheck check;
+    MatchSimulation sim;
+    ReplayPlayer player;
+    player.start(sim, replay);
+    int due = player.ticksDue(0.0, 0.0f);
+    for (int i = 0; i < due; ++i) {
+        sim.step(player.nextInput());
+    }
+
+    check.outcome = replayResultHash(sim) == replay.resultHash ? REPLAY_MATCHED : REPLAY_DIVERGED;
+    check.ticks = sim.state.tick;
+    check.winner = sim.winner();
+    check.health[0] = sim.health(0).health;
+    check.health[1] = sim.health(1).health;
+    return check;
+}
+
+static ReplayCheck checkReplay(const std::string& path) {
+    Replay replay;
+    if (!loadReplay(path, replay)) return ReplayCheck();
+    return runReplay(replay);
+}
+
+// Ghi trận bot theo đúng cách vòng frame của game ghi: mỗi frame chạy frameTicks tick cùng một
+// input và vẫn chạy nốt các tick của frame sau khi trận kết thúc. Bản ghi qua encode/decode rồi
+// chạy lại phải khớp hash. Trả về số trận không khớp
+static int recordTest(int matches, int frameTicks) {
+    const uint32_t MAX_TICKS = 180 * TICK_RATE;
+    int failures = 0;
+    MatchSimulation sim;
+    for (int m = 0; m < matches; ++m) {
+        uint64_t seedState = static_cast<uint64_t>(m) + 1;
+        uint64_t matchSeed = MatchRng::splitMix64(seedState);
+        sim.start((m / 2) % 2 ? DAU_SI : XA_THU, m % 2 ? DAU_SI : XA_THU, static_cast<uint32_t>(matchSeed));
+        MatchBot bot1(BOT_SCRIPTED, 0, static_cast<uint32_t>(matchSeed >> 32));
+        MatchBot bot2(BOT_SCRIPTED, 1, static_cast<uint32_t>(MatchRng::splitMix64(matchSeed)));
+        Replay replay;
+        replay.begin(sim);
+        bool recording = true;
+        while (recording) {
+            MatchInput input;
+            input.buttons[0] = bot1.think(sim);
+            input.buttons[1] = bot2.think(sim);
+            for (int t = 0; t < frameTicks; ++t) {
+                bool recordTick = recording && sim.isRunning();
+                if (recordTick) replay.record(input);
+                sim.step(input);
+                if (recordTick && replay.finishIfEnded(sim)) recording = false;
+            }
+            if (recording && sim.state.tick >= MAX_TICKS) {
+                replay.finish(sim);
+                recording = false;
+            }
+        }
+
+        std::vector<uint8_t> bytes;
+        encodeReplay(replay, bytes);
+        Replay loaded;
+        ReplayCheck check;
+        if (decodeReplay(bytes.data(), bytes.size(), loaded)) check = runReplay(loaded);
+        if (check.outcome != REPLAY_MATCHED) {
+            ++failures;
+            std::printf("record test match %d: %s, live tick %u, replay ticks %u\n", m,
+                check.outcome == REPLAY_DIVERGED ? "DIVERGED" : "unreadable", sim.state.tick, replay.tickCount);
+        }
+    }
+    std::printf("record test: %d matches at %d ticks per frame, %d failed\n", matches, frameTicks, failures);
+    return failures;
+}
+
+int main(int argc, char** argv) {
+    unsigned threads = 0;
+    bool verbose = false;
+    int recordTestTicks = 0;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        if (std::strcmp(arg, "--threads") == 0 && i + 1 < argc) threads = static_cast<unsigned>(std::atoi(argv[++i]));
+        else if (std::strcmp(arg, "--verbose") == 0) verbose = true;
+        else if (std::strcmp(arg, "--record-test") == 0 && i + 1 < argc) recordTestTicks = std::atoi(argv[++i]);
+        else if (arg[0] == '-') { printUsage(); return 1; }
+        else if (std::filesystem::is_directory(arg)) {
+            for (const auto& entry : std::filesystem::directory_iterator(arg)) {
+                if (entry.path().extension() == ".lqr") paths.push_back(entry.path().string());
+            }
+        }
+        else paths.push_back(arg);
+    }
+    Logger::instance().setLevel(LOG_LEVEL_WARN);
+    if (recordTestTicks > 0 && paths.empty()) {
+        return recordTest(32, recordTestTicks) == 0 ? 0 : 1;
+    }
+    if (paths.empty()) {
+        printUsage();
+        return 1;
+    }
+    std::sort(paths.begin(), paths.end());
+
+    std::vector<ReplayCheck> checks(paths.size());
+    auto startTime = std::chrono::steady_clock::now();
+    {
+        ThreadPool pool(threads);
+        for (size_t i = 0; i < paths.size(); ++i) {
+            pool.submit([&, i] { checks[i] = checkReplay(paths[i]); });
+        }
+        pool.wait();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    int counts[3] = { 0, 0, 0 };
+    uint64_t totalTicks = 0;
+    for (size_t i = 0; i < paths.size(); ++i) {
+        const ReplayCheck& check = checks[i];
+        ++counts[check.outcome];
+        totalTicks += check.ticks;
+        if (check.outcome == REPLAY_UNREADABLE) {
+            std::printf("%s: unreadable\n", paths[i].c_str());
+        }
+        else if (verbose || check.outcome == REPLAY_DIVERGED) {
+            std::printf("%s: %s, %u ticks, winner %d, health %.1f / %.1f\n", paths[i].c_str(),
+                check.outcome == REPLAY_MATCHED ? "ok" : "DIVERGED", check.ticks, check.winner,
+                check.health[0], check.health[1]);
+        }
+    }
+    std::printf("%zu replays: %d ok, %d diverged, %d unreadable; %llu ticks in %.2f s (%.0f ticks/s)\n",
+        paths.size(), counts[REPLAY_MATCHED], counts[REPLAY_DIVERGED], counts[REPLAY_UNREADABLE],
+        static_cast<unsigned long long>(totalTicks), seconds, totalTicks / seconds);
+    return counts[REPLAY_MATCHED] == static_cast<int>(paths.size()) ? 0 : 1;
+}
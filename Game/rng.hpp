@@ -0,0 +1,83 @@
+﻿#ifndef RNG_HPP
+#define RNG_HPP
+
+#include <cstdint>
+
+// Kết quả các lần tung xúc xắc của một đòn đánh
+struct CombatRoll {
+    bool hit;
+    bool crit;
+    float damage; // Đã nhân đôi nếu chí mạng
+};
+
+// Bộ sinh số ngẫu nhiên riêng cho từng trận (xoshiro128++).
+// Trạng thái 16 byte, sao chép được bằng memcpy, cùng seed cho cùng chuỗi số.
+class MatchRng {
+public:
+    MatchRng() { seed(0); }
+    explicit MatchRng(uint64_t value) { seed(value); }
+
+    void seed(uint64_t value) {
+        // Mở rộng seed bằng splitmix64 để trạng thái không bao giờ toàn 0
+        for (int i = 0; i < 4; i += 2) {
+            uint64_t z = splitMix64(value);
+            state[i] = static_cast<uint32_t>(z);
+            state[i + 1] = static_cast<uint32_t>(z >> 32);
+        }
+    }
+
+    uint32_t next() {
+        uint32_t result = rotl(state[0] + state[3], 7) + state[0];
+        uint32_t t = state[1] << 9;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotl(state[3], 11);
+        return result;
+    }
+
+    uint32_t operator()() { return next(); }
+
+    // Số nguyên trong [0, bound), dùng phép nhân thay cho phép chia lấy dư
+    uint32_t nextBelow(uint32_t bound) {
+        return static_cast<uint32_t>((static_cast<uint64_t>(next()) * bound) >> 32);
+    }
+
+    // Tung cùng lúc tỉ lệ trúng, sát thương và chí mạng của một đòn đánh.
+    // Hai lần gọi next() được chia thành các phần 16 bit cho từng giá trị.
+    // Sát thương là số nguyên trong [minDamage, maxDamage], chance tính theo phần trăm.
+    CombatRoll rollCombat(float hitChance, float minDamage, float maxDamage, float critChance = 20.0f) {
+        uint32_t a = next();
+        uint32_t b = next();
+        uint32_t damageRange = static_cast<uint32_t>(maxDamage - minDamage) + 1;
+
+        CombatRoll roll;
+        roll.hit = static_cast<int>(lane(a, 100)) < static_cast<int>(hitChance);
+        roll.crit = static_cast<int>(lane(a >> 16, 100)) < static_cast<int>(critChance);
+        roll.damage = minDamage + static_cast<float>(lane(b, damageRange));
+        if (roll.crit) roll.damage *= 2;
+        return roll;
+    }
+
+    static uint64_t splitMix64(uint64_t& value) {
+        uint64_t z = (value += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    uint32_t state[4];
+
+private:
+    static uint32_t rotl(uint32_t x, int k) {
+        return (x << k) | (x >> (32 - k));
+    }
+
+    static uint32_t lane(uint32_t bits, uint32_t bound) {
+        return ((bits & 0xFFFFu) * bound) >> 16;
+    }
+};
+
+#endif // RNG_HPP
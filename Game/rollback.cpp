@@ -0,0 +1,181 @@
+﻿#include "rollback.hpp"
+#include "profiler.hpp"
+#include <algorithm>
+
+static const uint8_t PACKET_MAGIC[2] = { 'L', 'N' };
+
+static void writeU32(uint8_t* out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) out[i] = static_cast<uint8_t>(value >> (8 * i));
+}
+
+static uint32_t readU32(const uint8_t* in) {
+    return in[0] | (in[1] << 8) | (in[2] << 16) | (static_cast<uint32_t>(in[3]) << 24);
+}
+
+static void writeU64(uint8_t* out, uint64_t value) {
+    writeU32(out, static_cast<uint32_t>(value));
+    writeU32(out + 4, static_cast<uint32_t>(value >> 32));
+}
+
+static uint64_t readU64(const uint8_t* in) {
+    return readU32(in) | (static_cast<uint64_t>(readU32(in + 4)) << 32);
+}
+
+void RollbackSession::start(MatchSimulation& sim, int localPlayer, int inputDelay, int maxPrediction) {
+    this->sim = &sim;
+    this->localPlayer = localPlayer;
+    this->inputDelay = std::clamp(inputDelay, 0, MAX_INPUT_DELAY);
+    this->maxPrediction = std::clamp(maxPrediction, 1, MAX_ROLLBACK_FRAMES);
+    // Ảnh chụp khá lớn nên chỉ xin một lần cho cả phiên
+    snapshots.resize(this->maxPrediction + 1);
+    snapshotFrames.assign(snapshots.size(), NO_FRAME);
+
+    std::fill(std::begin(localInputs), std::end(localInputs), 0);
+    std::fill(std::begin(remoteInputs), std::end(remoteInputs), 0);
+    std::fill(std::begin(usedRemote), std::end(usedRemote), 0);
+    frame = sim.state.tick;
+    // inputDelay frame đầu không có ai bấm gì, và được gửi đi như input bình thường
+    localCount = frame + this->inputDelay;
+    localAcked = frame;
+    remoteCount = frame;
+    firstMispredicted = NO_MISPREDICTION;
+    nextCheckFrame = (frame + DESYNC_CHECK_INTERVAL - 1) / DESYNC_CHECK_INTERVAL * DESYNC_CHECK_INTERVAL;
+    for (int i = 0; i < DESYNC_CHECK_HISTORY; ++i) {
+        localChecksums[i] = remoteChecksums[i] = FrameChecksum{ NO_FRAME, 0 };
+    }
+    lastLocalChecksum = FrameChecksum{ NO_FRAME, 0 };
+    desyncFrame = NO_DESYNC;
+    sessionStats = RollbackStats();
+}
+
+bool RollbackSession::advance(uint8_t localButtons) {
+    PROFILE_ZONE("RollbackSession::advance");
+    resolve();
+
+    // Đi trước quá xa thì đợi: rollback sẽ vượt quá ảnh chụp đang giữ,
+    // hoặc input chưa xác nhận không còn vừa một gói
+    if (frame >= remoteCount + maxPrediction || localCount - localAcked >= MAX_INPUTS_PER_PACKET) {
+        ++sessionStats.stalledFrames;
+        return false;
+    }
+
+    localInputs[slot(localCount++)] = localButtons;
+    stepFrame(frame++);
+    return true;
+}
+
+void RollbackSession::resolve() {
+    if (firstMispredicted != NO_MISPREDICTION) {
+        PROFILE_ZONE("RollbackSession::resolve");
+        uint32_t from = firstMispredicted;
+        firstMispredicted = NO_MISPREDICTION;
+        sim->restore(snapshots[from % snapshots.size()]);
+        for (uint32_t f = from; f < frame; ++f) {
+            stepFrame(f);
+        }
+
+        uint32_t depth = frame - from;
+        ++sessionStats.rollbacks;
+        sessionStats.resimulatedFrames += depth;
+        sessionStats.maxRollbackDepth = std::max(sessionStats.maxRollbackDepth, depth);
+    }
+    checkConfirmedState();
+}
+
+void RollbackSession::checkConfirmedState() {
+    // Frame đã chạy bằng dự đoán rồi mới được xác nhận: state trước nó nằm trong ảnh chụp
+    while (nextCheckFrame < frame && nextCheckFrame <= remoteCount && firstMispredicted == NO_MISPREDICTION) {
+        size_t index = nextCheckFrame % snapshots.size();
+        if (snapshotFrames[index] == nextCheckFrame) {
+            recordChecksum(localChecksums, nextCheckFrame, stateChecksum(snapshots[index]));
+        }
+        nextCheckFrame += DESYNC_CHECK_INTERVAL;
+    }
+}
+
+void RollbackSession::recordChecksum(FrameChecksum* history, uint32_t f, uint64_t value) {
+    FrameChecksum& entry = history[(f / DESYNC_CHECK_INTERVAL) % DESYNC_CHECK_HISTORY];
+    if (entry.frame == f) return; // Đối thủ gửi lại cùng checksum trong mỗi gói
+    entry = FrameChecksum{ f, value };
+    if (history == localChecksums) lastLocalChecksum = entry;
+
+    const FrameChecksum* other = history == localChecksums ? remoteChecksums : localChecksums;
+    const FrameChecksum& match = other[(f / DESYNC_CHECK_INTERVAL) % DESYNC_CHECK_HISTORY];
+    if (match.frame != f) return;
+    ++sessionStats.checksumsCompared;
+    if (match.value != value && f < desyncFrame) desyncFrame = f;
+}
+
+uint8_t RollbackSession::remoteInputFor(uint32_t f) const {
+    if (f < remoteCount) return remoteInputs[slot(f)];
+    // Đoán đối thủ giữ nguyên nút như lần cuối đã biết
+    return remoteCount > 0 ? remoteInputs[slot(remoteCount - 1)] : 0;
+}
+
+void RollbackSession::stepFrame(uint32_t f) {
+    // Mọi frame trước f đã có input thật nên state lúc này là state đúng của frame f
+    if (f == nextCheckFrame && f <= remoteCount) {
+        recordChecksum(localChecksums, f, sim->checksum());
+        nextCheckFrame += DESYNC_CHECK_INTERVAL;
+    }
+    // Frame đã có input thật của đối thủ thì không bao giờ phải quay lại nên khỏi chụp
+    if (f >= remoteCount) {
+        size_t index = f % snapshots.size();
+        sim->save(snapshots[index]);
+        snapshotFrames[index] = f;
+    }
+
+    MatchInput input;
+    uint8_t remote = remoteInputFor(f);
+    usedRemote[slot(f)] = remote;
+    input.buttons[localPlayer] = localInputs[slot(f)];
+    input.buttons[1 - localPlayer] = remote;
+    sim->step(input);
+}
+
+void RollbackSession::writePacket(std::vector<uint8_t>& out) const {
+    uint32_t count = std::min<uint32_t>(localCount - localAcked, MAX_INPUTS_PER_PACKET);
+    out.resize(ROLLBACK_PACKET_HEADER_SIZE + count);
+    out[0] = PACKET_MAGIC[0];
+    out[1] = PACKET_MAGIC[1];
+    writeU32(&out[2], localAcked);
+    writeU32(&out[6], remoteCount);
+    out[10] = static_cast<uint8_t>(count);
+    writeU32(&out[11], lastLocalChecksum.frame);
+    writeU64(&out[15], lastLocalChecksum.value);
+    for (uint32_t i = 0; i < count; ++i) {
+        out[ROLLBACK_PACKET_HEADER_SIZE + i] = localInputs[slot(localAcked + i)];
+    }
+}
+
+bool RollbackSession::readPacket(const uint8_t* data, size_t size) {
+    if (size < ROLLBACK_PACKET_HEADER_SIZE || data[0] != PACKET_MAGIC[0] || data[1] != PACKET_MAGIC[1] ||
+        size != ROLLBACK_PACKET_HEADER_SIZE + data[10] || data[10] > MAX_INPUTS_PER_PACKET) {
+        ++sessionStats.packetsRejected;
+        return false;
+    }
+    ++sessionStats.packetsReceived;
+
+    uint32_t firstFrame = readU32(data + 2);
+    uint32_t acked = readU32(data + 6);
+    uint32_t count = data[10];
+    uint32_t checksumFrame = readU32(data + 11);
+    if (checksumFrame != NO_FRAME && checksumFrame % DESYNC_CHECK_INTERVAL == 0) {
+        recordChecksum(remoteChecksums, checksumFrame, readU64(data + 15));
+    }
+    // Gói đến sai thứ tự có thể mang số xác nhận cũ hơn
+    if (acked > localAcked && acked <= localCount) localAcked = acked;
+
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t f = firstFrame + i;
+        if (f < remoteCount) continue;
+        if (f > remoteCount) break; // Hụt gói ở giữa; gói sau sẽ gửi lại từ remoteCount
+        uint8_t buttons = data[ROLLBACK_PACKET_HEADER_SIZE + i];
+        remoteInputs[slot(f)] = buttons;
+        ++remoteCount;
+        if (f < frame && usedRemote[slot(f)] != buttons) {
+            firstMispredicted = std::min(firstMispredicted, f);
+        }
+    }
+    return true;
+}
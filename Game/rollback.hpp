@@ -0,0 +1,107 @@
+﻿#ifndef ROLLBACK_HPP
+#define ROLLBACK_HPP
+
+#include "match_simulation.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+const int MAX_ROLLBACK_FRAMES = 16;    // Giới hạn trên của maxPrediction
+const int MAX_INPUT_DELAY = 8;
+const int ROLLBACK_INPUT_HISTORY = 64; // Lũy thừa của 2, lớn hơn 2 * (MAX_ROLLBACK_FRAMES + MAX_INPUT_DELAY)
+const int MAX_INPUTS_PER_PACKET = 32;
+const int DESYNC_CHECK_INTERVAL = 15;  // So checksum của state đã xác nhận mỗi chừng này frame
+const int DESYNC_CHECK_HISTORY = 8;
+// "LN", frame đầu, số input đã nhận, số input, frame và giá trị của checksum gần nhất
+const size_t ROLLBACK_PACKET_HEADER_SIZE = 23;
+const size_t MAX_ROLLBACK_PACKET_SIZE = ROLLBACK_PACKET_HEADER_SIZE + MAX_INPUTS_PER_PACKET;
+
+// Thống kê của một phiên, để chỉnh input delay và đo chi phí chạy lại
+struct RollbackStats {
+    uint32_t rollbacks = 0;          // Số lần phải khôi phục ảnh chụp
+    uint32_t resimulatedFrames = 0;  // Tổng số frame chạy lại
+    uint32_t maxRollbackDepth = 0;   // Số frame chạy lại nhiều nhất trong một lần
+    uint32_t stalledFrames = 0;      // Số lần advance() phải chờ đối thủ
+    uint32_t packetsReceived = 0;
+    uint32_t packetsRejected = 0;    // Gói hỏng hoặc sai định dạng
+    uint32_t checksumsCompared = 0;
+};
+
+// Netcode rollback kiểu GGPO cho trận PvP qua mạng, mỗi máy giữ một MatchSimulation đầy đủ.
+// Input của người chơi cục bộ được trễ inputDelay frame rồi gửi đi; input của đối thủ chưa
+// đến được đoán bằng input gần nhất đã nhận. Khi input thật khác dự đoán, sim được khôi phục
+// về ảnh chụp của frame sai đầu tiên và chạy lại đến frame hiện tại.
+// Phiên không tự gửi/nhận: writePacket()/readPacket() chỉ chuyển byte, transport do bên gọi chọn
+// (LoopbackTransport khi thử, UDP khi chơi thật). Mỗi gói mang mọi input đối thủ chưa xác nhận
+// nên mất gói chỉ làm input đến muộn hơn, không cần gửi lại.
+// Cứ DESYNC_CHECK_INTERVAL frame, checksum của state đã có input thật được gửi kèm gói để hai
+// máy so với nhau; khác nhau nghĩa là mô phỏng không xác định hoặc ảnh chụp thiếu dữ liệu.
+class RollbackSession {
+public:
+    // sim phải vừa start() với cùng seed và tướng ở hai máy. maxPrediction là số frame tối đa
+    // được chạy trước đối thủ (cũng là độ sâu rollback lớn nhất); vượt quá thì advance() chờ
+    void start(MatchSimulation& sim, int localPlayer, int inputDelay, int maxPrediction = 8);
+
+    // Chạy một frame với nút đang giữ của người chơi cục bộ; trước đó chạy lại các frame
+    // dự đoán sai. Trả về false (không chạy, không nhận input) nếu đã đi trước đối thủ quá xa
+    bool advance(uint8_t localButtons);
+    // Chạy lại các frame dự đoán sai ngay và so checksum của các frame vừa được xác nhận,
+    // không tiến thêm frame; advance() tự gọi
+    void resolve();
+
+    // Gói gửi cho đối thủ: input cục bộ chưa được xác nhận và số input của đối thủ đã nhận
+    void writePacket(std::vector<uint8_t>& out) const;
+    // Nhận gói của đối thủ; gói trùng, cũ hoặc đến sai thứ tự đều dùng được. false nếu gói hỏng
+    bool readPacket(const uint8_t* data, size_t size);
+
+    // Số frame đã chạy (bằng sim.state.tick) và số frame đầu đã có input thật của cả hai người chơi
+    uint32_t currentFrame() const { return frame; }
+    uint32_t confirmedFrame() const { return remoteCount < frame ? remoteCount : frame; }
+    // Sim đúng với input thật đến currentFrame(), không còn frame nào phải chạy lại
+    bool synchronized() const { return remoteCount >= frame && firstMispredicted == NO_MISPREDICTION; }
+    const RollbackStats& stats() const { return sessionStats; }
+    // Frame đầu tiên có checksum khác đối thủ, NO_DESYNC nếu chưa thấy
+    bool desynced() const { return desyncFrame != NO_DESYNC; }
+    uint32_t firstDesyncFrame() const { return desyncFrame; }
+
+    static constexpr uint32_t NO_DESYNC = 0xFFFFFFFFu;
+
+private:
+    static constexpr uint32_t NO_MISPREDICTION = 0xFFFFFFFFu;
+    static constexpr uint32_t NO_FRAME = 0xFFFFFFFFu;
+
+    struct FrameChecksum {
+        uint32_t frame; // NO_FRAME nếu ô còn trống
+        uint64_t value;
+    };
+
+    static size_t slot(uint32_t f) { return f & (ROLLBACK_INPUT_HISTORY - 1); }
+    uint8_t remoteInputFor(uint32_t f) const;
+    void stepFrame(uint32_t f);
+    void checkConfirmedState();
+    void recordChecksum(FrameChecksum* history, uint32_t f, uint64_t value);
+
+    MatchSimulation* sim = nullptr;
+    int localPlayer = 0;
+    int inputDelay = 0;
+    int maxPrediction = 8;
+    std::vector<MatchState> snapshots;   // Trạng thái trước frame f nằm ở snapshots[f % size]
+    std::vector<uint32_t> snapshotFrames; // Frame của từng ảnh chụp
+
+    uint8_t localInputs[ROLLBACK_INPUT_HISTORY] = {};
+    uint8_t remoteInputs[ROLLBACK_INPUT_HISTORY] = {};
+    uint8_t usedRemote[ROLLBACK_INPUT_HISTORY] = {}; // Input đối thủ đã dùng khi chạy frame f
+    uint32_t frame = 0;
+    uint32_t localCount = 0;    // Input cục bộ cho các frame [0, localCount) đã có
+    uint32_t localAcked = 0;    // Đối thủ đã nhận input cục bộ [0, localAcked)
+    uint32_t remoteCount = 0;   // Đã nhận input đối thủ cho các frame [0, remoteCount)
+    uint32_t firstMispredicted = NO_MISPREDICTION;
+    uint32_t nextCheckFrame = 0; // Frame kế tiếp cần tính checksum, bội của DESYNC_CHECK_INTERVAL
+    FrameChecksum localChecksums[DESYNC_CHECK_HISTORY];
+    FrameChecksum remoteChecksums[DESYNC_CHECK_HISTORY];
+    FrameChecksum lastLocalChecksum;
+    uint32_t desyncFrame = NO_DESYNC;
+    RollbackStats sessionStats;
+};
+
+#endif // ROLLBACK_HPP
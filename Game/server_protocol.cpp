@@ -0,0 +1,96 @@
+﻿#include "server_protocol.hpp"
+#include <cstring>
+
+static const uint8_t PACKET_MAGIC[2] = { 'L', 'S' };
+static const size_t PACKET_HEADER_SIZE = 7; // Magic, loại gói, matchId
+
+static void writeU16(uint8_t* out, uint16_t value) {
+    out[0] = static_cast<uint8_t>(value);
+    out[1] = static_cast<uint8_t>(value >> 8);
+}
+
+static uint16_t readU16(const uint8_t* in) {
+    return static_cast<uint16_t>(in[0] | (in[1] << 8));
+}
+
+static void writeU32(uint8_t* out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) out[i] = static_cast<uint8_t>(value >> (8 * i));
+}
+
+static uint32_t readU32(const uint8_t* in) {
+    return in[0] | (in[1] << 8) | (in[2] << 16) | (static_cast<uint32_t>(in[3]) << 24);
+}
+
+size_t writeServerPacket(const ServerPacket& packet, uint8_t* out) {
+    out[0] = PACKET_MAGIC[0];
+    out[1] = PACKET_MAGIC[1];
+    out[2] = packet.type;
+    writeU32(out + 3, packet.matchId);
+    uint8_t* body = out + PACKET_HEADER_SIZE;
+
+    switch (packet.type) {
+    case PACKET_JOIN:
+        body[0] = packet.player;
+        body[1] = packet.character;
+        return PACKET_HEADER_SIZE + 2;
+    case PACKET_WELCOME:
+    case PACKET_REJECT:
+        body[0] = packet.player;
+        return PACKET_HEADER_SIZE + 1;
+    case PACKET_REDIRECT:
+        writeU16(body, packet.port);
+        return PACKET_HEADER_SIZE + 2;
+    case PACKET_INPUT:
+        body[0] = packet.player;
+        writeU32(body + 1, packet.snapshotAck);
+        writeU32(body + 5, packet.firstFrame);
+        body[9] = packet.inputCount;
+        std::memcpy(body + 10, packet.buttons, packet.inputCount);
+        return PACKET_HEADER_SIZE + 10 + packet.inputCount;
+    case PACKET_SNAPSHOT:
+        writeU32(body, packet.firstFrame);
+        std::memcpy(body + 4, packet.payload, packet.payloadSize);
+        return PACKET_HEADER_SIZE + 4 + packet.payloadSize;
+    }
+    return 0;
+}
+
+bool readServerPacket(const uint8_t* data, size_t size, ServerPacket& packet) {
+    if (size < PACKET_HEADER_SIZE || data[0] != PACKET_MAGIC[0] || data[1] != PACKET_MAGIC[1]) return false;
+    packet.type = static_cast<ServerPacketType>(data[2]);
+    packet.matchId = readU32(data + 3);
+    const uint8_t* body = data + PACKET_HEADER_SIZE;
+    size_t bodySize = size - PACKET_HEADER_SIZE;
+
+    switch (packet.type) {
+    case PACKET_JOIN:
+        if (bodySize != 2 || body[0] > 1 || body[1] > 1) return false;
+        packet.player = body[0];
+        packet.character = body[1];
+        return true;
+    case PACKET_WELCOME:
+    case PACKET_REJECT:
+        if (bodySize != 1 || body[0] > 1) return false;
+        packet.player = body[0];
+        return true;
+    case PACKET_REDIRECT:
+        if (bodySize != 2) return false;
+        packet.port = readU16(body);
+        return true;
+    case PACKET_INPUT:
+        if (bodySize < 10 || body[0] > 1 || body[9] > MAX_SERVER_INPUTS_PER_PACKET || bodySize != 10u + body[9]) return false;
+        packet.player = body[0];
+        packet.snapshotAck = readU32(body + 1);
+        packet.firstFrame = readU32(body + 5);
+        packet.inputCount = body[9];
+        std::memcpy(packet.buttons, body + 10, packet.inputCount);
+        return true;
+    case PACKET_SNAPSHOT:
+        if (bodySize < 4) return false;
+        packet.firstFrame = readU32(body);
+        packet.payload = body + 4;
+        packet.payloadSize = bodySize - 4;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,38 @@
+﻿#ifndef SERVER_PROTOCOL_HPP
+#define SERVER_PROTOCOL_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+const int MAX_SERVER_INPUTS_PER_PACKET = 32;
+
+// Mọi gói giữa client và dedicated server bắt đầu bằng "LS" và một byte ServerPacketType
+enum ServerPacketType : uint8_t {
+    PACKET_JOIN = 1,  // Client -> server: vào trận matchId với vai player và tướng character
+    PACKET_WELCOME,   // Server -> client: đã nhận JOIN, đang chờ đối thủ
+    PACKET_REDIRECT,  // Server -> client: trận do worker khác giữ, gửi lại JOIN tới cổng port
+    PACKET_REJECT,    // Server -> client: server đầy hoặc vai đã có người
+    PACKET_INPUT,     // Client -> server: nút của các frame [firstFrame, firstFrame + inputCount) và snapshot mới nhất đã nhận
+    PACKET_SNAPSHOT   // Server -> client: snapshot trận, firstFrame là số input của client đã nhận
+};
+
+struct ServerPacket {
+    ServerPacketType type = PACKET_JOIN;
+    uint32_t matchId = 0;
+    uint8_t player = 0;
+    uint8_t character = 0;     // JOIN
+    uint16_t port = 0;         // REDIRECT
+    uint32_t firstFrame = 0;   // INPUT, SNAPSHOT
+    uint32_t snapshotAck = 0;  // INPUT: tick của snapshot mới nhất client đã giải mã, server dùng làm baseline
+    uint8_t inputCount = 0;    // INPUT
+    uint8_t buttons[MAX_SERVER_INPUTS_PER_PACKET] = {};
+    const uint8_t* payload = nullptr; // SNAPSHOT: dữ liệu của encodeSnapshot, trỏ vào gói gốc khi đọc
+    size_t payloadSize = 0;
+};
+
+// Ghi gói vào out (ít nhất MAX_UDP_PACKET_SIZE byte), trả về số byte
+size_t writeServerPacket(const ServerPacket& packet, uint8_t* out);
+// false nếu không phải gói của server hoặc dữ liệu hỏng
+bool readServerPacket(const uint8_t* data, size_t size, ServerPacket& packet);
+
+#endif // SERVER_PROTOCOL_HPP
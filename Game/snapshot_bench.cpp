@@ -0,0 +1,195 @@
+﻿#include "match_snapshot.hpp"
+#include "match_bot.hpp"
+#include "logger.hpp"
+#include "rng.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// Đo kích thước và tốc độ mã hoá snapshot trên các trận bot thật: bản đầy đủ và bản delta
+// so với snapshot client đã báo nhận cách đây --ack-delay snapshot.
+// Ví dụ: snapshot_bench --matches 20 --interval 2 --ack-delay 3
+
+struct BenchOptions {
+    int matches = 20;
+    int interval = 2;  // Gửi snapshot mỗi chừng này tick, như --snapshot-interval của server
+    int ackDelay = 3;  // Baseline là snapshot cách chừng này bản (3 x 2 tick ~ 100 ms khứ hồi)
+    uint64_t seed = 1;
+    uint32_t maxTicks = 180 * TICK_RATE;
+};
+
+struct FormatStats {
+    uint64_t bytes = 0;
+    double encodeSeconds = 0.0;
+    double decodeSeconds = 0.0;
+};
+
+// Định dạng trước khi có delta: mọi số là float 4 byte, không có hồi chiêu và vận tốc mũi tên
+static size_t floatSnapshotSize(const MatchSnapshot& snapshot) {
+    return 4 + 2 + 2 * 26 + 1 + snapshot.buffCount * 9 + 1 + snapshot.projectileCount * 9;
+}
+
+static bool samePlayer(const SnapshotPlayer& a, const SnapshotPlayer& b) {
+    for (int c = 0; c < SNAPSHOT_COOLDOWN_COUNT; ++c) {
+        if (a.cooldownTicks[c] != b.cooldownTicks[c]) return false;
+    }
+    return a.x == b.x && a.y == b.y && a.size == b.size && a.health == b.health && a.maxHealth == b.maxHealth &&
+        a.speed == b.speed && a.type == b.type && a.flags == b.flags;
+}
+
+static bool sameSnapshot(const MatchSnapshot& a, const MatchSnapshot& b) {
+    if (a.tick != b.tick || a.gameEnded != b.gameEnded || a.winner != b.winner ||
+        !samePlayer(a.players[0], b.players[0]) || !samePlayer(a.players[1], b.players[1]) ||
+        a.buffCount != b.buffCount || a.projectileCount != b.projectileCount) {
+        return false;
+    }
+    for (int i = 0; i < a.buffCount; ++i) {
+        const SnapshotBuff& x = a.buffs[i];
+        const SnapshotBuff& y = b.buffs[i];
+        if (x.x != y.x || x.y != y.y || x.type != y.type) return false;
+    }
+    for (int i = 0; i < a.projectileCount; ++i) {
+        const SnapshotProjectile& x = a.projectiles[i];
+        const SnapshotProjectile& y = b.projectiles[i];
+        if (x.x != y.x || x.y != y.y || x.velocityX != y.velocityX || x.velocityY != y.velocityY || x.owner != y.owner) return false;
+    }
+    return true;
+}
+
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Mã hoá rồi giải mã mọi snapshot của một trận; ackDelay 0 nghĩa là luôn gửi bản đầy đủ.
+// false nếu bản giải mã khác bản gốc
+static bool runFormat(const std::vector<MatchSnapshot>& snapshots, int ackDelay, FormatStats& stats) {
+    size_t count = snapshots.size();
+    std::vector<uint8_t> encoded(count * MAX_SNAPSHOT_SIZE);
+    std::vector<size_t> sizes(count);
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < count; ++i) {
+        const MatchSnapshot* baseline = ackDelay > 0 && i >= static_cast<size_t>(ackDelay) ? &snapshots[i - ackDelay] : nullptr;
+        sizes[i] = encodeSnapshot(snapshots[i], baseline, &encoded[i * MAX_SNAPSHOT_SIZE], MAX_SNAPSHOT_SIZE);
+    }
+    stats.encodeSeconds += secondsSince(start);
+
+    // Client lưu mọi snapshot giải mã được làm baseline như bot_client; thời gian đo gồm cả lần lưu đó
+    static SnapshotHistory history;
+    static MatchSnapshot decoded[2];
+    history.clear();
+    bool ok = true;
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < count; ++i) {
+        MatchSnapshot& out = decoded[i & 1];
+        ok = decodeSnapshot(&encoded[i * MAX_SNAPSHOT_SIZE], sizes[i], history, out) && ok;
+        history.store(out);
+    }
+    stats.decodeSeconds += secondsSince(start);
+
+    // Kiểm tra lại ngoài vòng đo
+    history.clear();
+    for (size_t i = 0; i < count && ok; ++i) {
+        ok = sizes[i] > 0 && decodeSnapshot(&encoded[i * MAX_SNAPSHOT_SIZE], sizes[i], history, decoded[0]) &&
+            sameSnapshot(decoded[0], snapshots[i]);
+        history.store(decoded[0]);
+        stats.bytes += sizes[i];
+    }
+    return ok;
+}
+
+static void printUsage() {
+    std::fprintf(stderr,
+        "Usage: snapshot_bench [options]\n"
+        "  --matches N     so tran bot (mac dinh 20)\n"
+        "  --interval N    gui snapshot moi N tick (mac dinh 2)\n"
+        "  --ack-delay N   baseline cach N snapshot (mac dinh 3)\n"
+        "  --seed N        seed goc (mac dinh 1)\n"
+        "  --max-ticks N   so tick toi da moi tran\n");
+}
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(arg, "--matches") == 0 && hasValue) options.matches = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "--interval") == 0 && hasValue) options.interval = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "--ack-delay") == 0 && hasValue) options.ackDelay = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "--seed") == 0 && hasValue) options.seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (std::strcmp(arg, "--max-ticks") == 0 && hasValue) options.maxTicks = static_cast<uint32_t>(std::atoi(argv[++i]));
+        else {
+            printUsage();
+            return 1;
+        }
+    }
+    if (options.matches < 1 || options.interval < 1 || options.ackDelay < 1 || options.ackDelay >= SNAPSHOT_HISTORY) {
+        printUsage();
+        return 1;
+    }
+
+    Logger::instance().setLevel(LOG_LEVEL_WARN);
+
+    static MatchSimulation sim;
+    std::vector<MatchSnapshot> snapshots;
+    uint64_t totalTicks = 0, floatBytes = 0, snapshotCount = 0, projectileCount = 0;
+    FormatStats full, delta;
+
+    for (int m = 0; m < options.matches; ++m) {
+        // Xoay qua bốn cặp đấu như batch_runner và dedicated_server
+        CharacterType p1 = (m / 2) % 2 ? DAU_SI : XA_THU;
+        CharacterType p2 = m % 2 ? DAU_SI : XA_THU;
+        uint64_t seedState = options.seed + m;
+        uint64_t matchSeed = MatchRng::splitMix64(seedState);
+        sim.start(p1, p2, static_cast<uint32_t>(matchSeed));
+        MatchBot bot1(BOT_SCRIPTED, 0, static_cast<uint32_t>(matchSeed >> 32));
+        MatchBot bot2(BOT_SCRIPTED, 1, static_cast<uint32_t>(MatchRng::splitMix64(matchSeed)));
+
+        snapshots.clear();
+        snapshots.emplace_back();
+        captureSnapshot(sim, snapshots.back());
+        while (sim.isRunning() && sim.state.tick < options.maxTicks) {
+            MatchInput input;
+            input.buttons[0] = bot1.think(sim);
+            input.buttons[1] = bot2.think(sim);
+            sim.step(input);
+            if (sim.state.tick % options.interval == 0 || !sim.isRunning()) {
+                snapshots.emplace_back();
+                captureSnapshot(sim, snapshots.back());
+            }
+        }
+        totalTicks += sim.state.tick;
+        for (const MatchSnapshot& snapshot : snapshots) {
+            floatBytes += floatSnapshotSize(snapshot);
+            projectileCount += snapshot.projectileCount;
+        }
+        snapshotCount += snapshots.size();
+
+        if (!runFormat(snapshots, 0, full) || !runFormat(snapshots, options.ackDelay, delta)) {
+            std::printf("Match %d: decoded snapshot differs from the original\n", m);
+            return 1;
+        }
+    }
+
+    std::printf("%d matches, %llu ticks, %llu snapshots (every %d ticks, baseline %d snapshots back), %.1f arrows avg\n",
+        options.matches, static_cast<unsigned long long>(totalTicks), static_cast<unsigned long long>(snapshotCount),
+        options.interval, options.ackDelay, static_cast<double>(projectileCount) / snapshotCount);
+    std::printf("%8s %14s %11s %12s %10s %10s\n", "format", "bytes/snapshot", "bytes/tick", "kbit/s", "encode ns", "decode ns");
+    auto printRow = [&](const char* name, uint64_t bytes, const FormatStats* stats) {
+        double perTick = static_cast<double>(bytes) / totalTicks;
+        std::printf("%8s %14.1f %11.2f %12.2f", name, static_cast<double>(bytes) / snapshotCount, perTick,
+            perTick * TICK_RATE * 8.0 / 1000.0);
+        if (stats) {
+            std::printf(" %10.0f %10.0f\n", stats->encodeSeconds * 1e9 / snapshotCount, stats->decodeSeconds * 1e9 / snapshotCount);
+        }
+        else {
+            std::printf(" %10s %10s\n", "-", "-");
+        }
+    };
+    printRow("float", floatBytes, nullptr);
+    printRow("full", full.bytes, &full);
+    printRow("delta", delta.bytes, &delta);
+    return 0;
+}
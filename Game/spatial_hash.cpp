@@ -0,0 +1,141 @@
+﻿#include "spatial_hash.hpp"
+#include <algorithm>
+#include <new>
+
+void SpatialHash::clear() {
+    std::fill(std::begin(buckets), std::end(buckets), -1);
+    std::fill(std::begin(visitedStamp), std::end(visitedStamp), 0u);
+    for (int i = 0; i < NODE_COUNT; ++i) {
+        nodes[i].next = i + 1 < NODE_COUNT ? i + 1 : -1;
+    }
+    freeNode = 0;
+    entryCount = 0;
+    freeHandleCount = 0;
+    std::fill(std::begin(layerCounts), std::end(layerCounts), 0);
+    occupiedLayers = 0;
+    currentStamp = 0;
+}
+
+void SpatialHash::countLayer(uint32_t layer, int delta) {
+    for (int bit = 0; bit < 32; ++bit) {
+        if (!(layer & (1u << bit))) continue;
+        layerCounts[bit] += delta;
+        if (layerCounts[bit] > 0) occupiedLayers |= 1u << bit;
+        else occupiedLayers &= ~(1u << bit);
+    }
+}
+
+int SpatialHash::cellCoord(float value) const {
+    // Làm tròn xuống bằng phép ép kiểu; std::floor không có SSE4.1 sẽ gọi hàm thư viện
+    float scaled = value * (1.0f / SPATIAL_HASH_CELL_SIZE);
+    int cell = static_cast<int>(scaled);
+    return cell - (scaled < static_cast<float>(cell));
+}
+
+int SpatialHash::add(const CollisionBox& box, uint32_t layer, uint32_t userData) {
+    int handle;
+    if (freeHandleCount > 0) {
+        handle = freeHandles[--freeHandleCount];
+    }
+    else {
+        if (entryCount >= MAX_COLLIDERS) return -1;
+        handle = entryCount++;
+    }
+    Entry& entry = entries[handle];
+    entry.box = box;
+    entry.layer = layer;
+    entry.userData = userData;
+    entry.alive = true;
+    entry.cellX0 = cellCoord(box.minX);
+    entry.cellY0 = cellCoord(box.minY);
+    entry.cellX1 = cellCoord(box.maxX);
+    entry.cellY1 = cellCoord(box.maxY);
+    insertCells(handle);
+    countLayer(layer, 1);
+    return handle;
+}
+
+void SpatialHash::update(int handle, const CollisionBox& box) {
+    Entry& entry = entries[handle];
+    entry.box = box;
+    int x0 = cellCoord(box.minX), y0 = cellCoord(box.minY);
+    int x1 = cellCoord(box.maxX), y1 = cellCoord(box.maxY);
+    if (x0 == entry.cellX0 && y0 == entry.cellY0 && x1 == entry.cellX1 && y1 == entry.cellY1) {
+        return;
+    }
+    removeCells(handle);
+    entry.cellX0 = x0;
+    entry.cellY0 = y0;
+    entry.cellX1 = x1;
+    entry.cellY1 = y1;
+    insertCells(handle);
+}
+
+void SpatialHash::remove(int handle) {
+    Entry& entry = entries[handle];
+    if (!entry.alive) return;
+    removeCells(handle);
+    countLayer(entry.layer, -1);
+    entry.alive = false;
+    freeHandles[freeHandleCount++] = handle;
+}
+
+void SpatialHash::insertCells(int handle) {
+    const Entry& entry = entries[handle];
+    for (int cy = entry.cellY0; cy <= entry.cellY1; ++cy) {
+        for (int cx = entry.cellX0; cx <= entry.cellX1; ++cx) {
+            // Chỉ hết nút khi hộp chạm nhiều hơn MAX_CELLS_PER_COLLIDER ô
+            if (freeNode < 0) throw std::bad_alloc();
+            int node = freeNode;
+            freeNode = nodes[node].next;
+            int& head = buckets[bucketIndex(cx, cy)];
+            nodes[node].handle = handle;
+            nodes[node].next = head;
+            head = node;
+        }
+    }
+}
+
+void SpatialHash::removeCells(int handle) {
+    const Entry& entry = entries[handle];
+    for (int cy = entry.cellY0; cy <= entry.cellY1; ++cy) {
+        for (int cx = entry.cellX0; cx <= entry.cellX1; ++cx) {
+            int* link = &buckets[bucketIndex(cx, cy)];
+            while (*link >= 0 && nodes[*link].handle != handle) {
+                link = &nodes[*link].next;
+            }
+            if (*link >= 0) {
+                int node = *link;
+                *link = nodes[node].next;
+                nodes[node].next = freeNode;
+                freeNode = node;
+            }
+        }
+    }
+}
+
+void SpatialHash::query(const CollisionBox& box, uint32_t layerMask, std::vector<int>& out) const {
+    out.clear();
+    if (!(layerMask & occupiedLayers)) return;
+    if (++currentStamp == 0) {
+        std::fill(std::begin(visitedStamp), std::end(visitedStamp), 0u);
+        currentStamp = 1;
+    }
+    int x0 = cellCoord(box.minX), y0 = cellCoord(box.minY);
+    int x1 = cellCoord(box.maxX), y1 = cellCoord(box.maxY);
+    for (int cy = y0; cy <= y1; ++cy) {
+        for (int cx = x0; cx <= x1; ++cx) {
+            for (int node = buckets[bucketIndex(cx, cy)]; node >= 0; node = nodes[node].next) {
+                int handle = nodes[node].handle;
+                if (visitedStamp[handle] == currentStamp) continue;
+                visitedStamp[handle] = currentStamp;
+                const Entry& entry = entries[handle];
+                if ((entry.layer & layerMask) && boxesOverlap(entry.box, box)) {
+                    out.push_back(handle);
+                }
+            }
+        }
+    }
+    // Thứ tự trong ô phụ thuộc lịch sử thêm/xóa; sắp xếp để kết quả luôn xác định
+    if (out.size() > 1) std::sort(out.begin(), out.end());
+}
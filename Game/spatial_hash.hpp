@@ -0,0 +1,91 @@
+﻿#ifndef SPATIAL_HASH_HPP
+#define SPATIAL_HASH_HPP
+
+#include "game_config.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+const int MAX_COLLIDERS = MAX_MATCH_ENTITIES;
+const int MAX_CELLS_PER_COLLIDER = 9; // Một nhân vật 400x400 nằm trên tối đa 3x3 ô 256
+const int SPATIAL_HASH_BUCKETS = 256;  // Lũy thừa của 2
+constexpr float SPATIAL_HASH_CELL_SIZE = 256.0f;
+
+// Lớp va chạm, dùng làm mặt nạ khi truy vấn
+enum CollisionLayer : uint32_t {
+    COLLIDE_CHARACTER = 1 << 0,
+    COLLIDE_BUFF = 1 << 1,
+};
+
+struct CollisionBox {
+    float minX, minY;
+    float maxX, maxY;
+};
+
+// Hai hộp chồng lên nhau (chạm cạnh không tính), giống isColliding trong character.cpp
+inline bool boxesOverlap(const CollisionBox& a, const CollisionBox& b) {
+    return a.minX < b.maxX && a.maxX > b.minX && a.minY < b.maxY && a.maxY > b.minY;
+}
+
+// Broadphase lưới đều: thế giới chia thành ô SPATIAL_HASH_CELL_SIZE, mỗi ô được băm vào một
+// trong SPATIAL_HASH_BUCKETS bucket giữ danh sách các hộp chạm vào nó. Lưới không giới hạn
+// kích thước; hai ô trùng bucket chỉ làm truy vấn xét thêm vài hộp thừa.
+// Cập nhật vị trí chỉ sửa bucket khi hộp đổi sang ô khác, nên có thể gọi mỗi tick cho mọi vật thể.
+// Mỗi bucket là danh sách liên kết các nút lấy từ free list; nút, hộp và bucket là mảng cố định
+// nối với nhau bằng chỉ số, nên thêm/xóa/cập nhật không cấp phát và đối tượng sao chép được bằng memcpy.
+class SpatialHash {
+public:
+    // Bỏ mọi hộp; phải gọi trước lần dùng đầu tiên
+    void clear();
+
+    // Thêm hộp và trả về handle, -1 nếu đã đủ MAX_COLLIDERS; userData được trả lại khi truy vấn
+    int add(const CollisionBox& box, uint32_t layer, uint32_t userData);
+    void update(int handle, const CollisionBox& box);
+    void remove(int handle);
+
+    // Ghi vào out handle của mọi hộp thuộc layerMask chồng lên box, tăng dần và không trùng
+    void query(const CollisionBox& box, uint32_t layerMask, std::vector<int>& out) const;
+    uint32_t userData(int handle) const { return entries[handle].userData; }
+    const CollisionBox& box(int handle) const { return entries[handle].box; }
+    size_t size() const { return entryCount - freeHandleCount; }
+
+private:
+    struct Entry {
+        CollisionBox box;
+        uint32_t layer;
+        uint32_t userData;
+        int cellX0, cellY0, cellX1, cellY1; // Khoảng ô đang chiếm (bao gồm hai đầu)
+        bool alive;
+        uint8_t padding[3];
+    };
+
+    struct CellNode {
+        int handle;
+        int next; // -1 ở cuối bucket hoặc cuối free list
+    };
+
+    size_t bucketIndex(int cellX, int cellY) const {
+        uint32_t hash = (static_cast<uint32_t>(cellX) * 73856093u) ^ (static_cast<uint32_t>(cellY) * 19349663u);
+        return hash & (SPATIAL_HASH_BUCKETS - 1);
+    }
+    int cellCoord(float value) const;
+    void countLayer(uint32_t layer, int delta);
+    void insertCells(int handle);
+    void removeCells(int handle);
+
+    static const int NODE_COUNT = MAX_COLLIDERS * MAX_CELLS_PER_COLLIDER;
+
+    Entry entries[MAX_COLLIDERS];
+    int entryCount;                 // Số handle đã từng cấp
+    int freeHandles[MAX_COLLIDERS];
+    int freeHandleCount;
+    int buckets[SPATIAL_HASH_BUCKETS]; // Nút đầu của từng bucket, -1 nếu rỗng
+    CellNode nodes[NODE_COUNT];
+    int freeNode;
+    int layerCounts[32];          // Số hộp của từng bit layer
+    uint32_t occupiedLayers;      // Bit layer còn ít nhất một hộp, để bỏ qua truy vấn khi layer rỗng
+    mutable uint32_t visitedStamp[MAX_COLLIDERS]; // Chống trùng khi một hộp nằm trên nhiều ô
+    mutable uint32_t currentStamp;
+};
+
+#endif // SPATIAL_HASH_HPP
@@ -0,0 +1,170 @@
+﻿#include "sprite_batch.hpp"
+#include "profiler.hpp"
+#include <algorithm>
+#include <cstddef>
+
+const char* SpriteBatch::vertexShaderSource = R"(
+    #version 330 core
+    layout(location = 0) in vec2 aCorner;
+    layout(location = 1) in vec4 aRect;
+    layout(location = 2) in vec4 aUV;
+    layout(location = 3) in vec4 aColor;
+    uniform vec2 screenSize;
+    out vec2 TexCoord;
+    out vec4 Tint;
+    void main() {
+        vec2 pos = mix(aRect.xy, aRect.zw, aCorner);
+        gl_Position = vec4(pos.x / screenSize.x * 2.0 - 1.0, 1.0 - pos.y / screenSize.y * 2.0, 0.0, 1.0);
+        TexCoord = mix(aUV.xy, aUV.zw, aCorner);
+        Tint = aColor;
+    }
+)";
+
+const char* SpriteBatch::fragmentShaderSource = R"(
+    #version 330 core
+    in vec2 TexCoord;
+    in vec4 Tint;
+    out vec4 FragColor;
+    uniform sampler2D texture1;
+    void main() {
+        FragColor = texture(texture1, TexCoord) * Tint;
+    }
+)";
+
+static uint8_t toByte(float value) {
+    return static_cast<uint8_t>(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+
+SpriteBatch::SpriteBatch()
+    : shaderProgram(0), vao(0), quadVBO(0), instanceVBO(0), whiteTexture(0),
+    screenSizeLocation(-1), textureLocation(-1), instanceCapacity(0),
+    screenWidth(1.0f), screenHeight(1.0f), drawCallCount(0), spriteCount(0) {
+}
+
+SpriteBatch::~SpriteBatch() {
+    shutdown();
+}
+
+bool SpriteBatch::init(GLuint program) {
+    shaderProgram = program;
+    if (shaderProgram == 0) return false;
+    screenSizeLocation = glGetUniformLocation(shaderProgram, "screenSize");
+    textureLocation = glGetUniformLocation(shaderProgram, "texture1");
+
+    const float corners[] = { 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f };
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &quadVBO);
+    glGenBuffers(1, &instanceVBO);
+
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    for (GLuint attrib = 1; attrib <= 3; ++attrib) {
+        glEnableVertexAttribArray(attrib);
+        glVertexAttribDivisor(attrib, 1);
+    }
+    setInstanceAttributes(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+
+    // Texture trắng 1x1 để vẽ hình chữ nhật màu trong cùng batch
+    const uint8_t white[4] = { 255, 255, 255, 255 };
+    glGenTextures(1, &whiteTexture);
+    glBindTexture(GL_TEXTURE_2D, whiteTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return true;
+}
+
+void SpriteBatch::shutdown() {
+    if (vao) glDeleteVertexArrays(1, &vao);
+    if (quadVBO) glDeleteBuffers(1, &quadVBO);
+    if (instanceVBO) glDeleteBuffers(1, &instanceVBO);
+    if (whiteTexture) glDeleteTextures(1, &whiteTexture);
+    vao = quadVBO = instanceVBO = whiteTexture = 0;
+    instanceCapacity = 0;
+}
+
+void SpriteBatch::setInstanceAttributes(size_t firstInstance) {
+    const GLsizei stride = sizeof(SpriteInstance);
+    const size_t base = firstInstance * sizeof(SpriteInstance);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, stride, (void*)(base + offsetof(SpriteInstance, rect)));
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, stride, (void*)(base + offsetof(SpriteInstance, uv)));
+    glVertexAttribPointer(3, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, (void*)(base + offsetof(SpriteInstance, color)));
+}
+
+void SpriteBatch::begin(float width, float height) {
+    screenWidth = width;
+    screenHeight = height;
+    entries.clear();
+}
+
+void SpriteBatch::draw(GLuint textureID, float x0, float y0, float x1, float y1,
+    float u0, float v0, float u1, float v1, int layer, Color tint) {
+    SpriteEntry entry;
+    entry.key = (static_cast<uint64_t>(layer) << 32) | textureID;
+    entry.sequence = static_cast<uint32_t>(entries.size());
+    entry.instance = { { x0, y0, x1, y1 }, { u0, v0, u1, v1 },
+        { toByte(tint.r), toByte(tint.g), toByte(tint.b), toByte(tint.a) } };
+    entries.push_back(entry);
+}
+
+void SpriteBatch::drawRect(float x0, float y0, float x1, float y1, Color color, int layer) {
+    draw(whiteTexture, x0, y0, x1, y1, 0.0f, 0.0f, 1.0f, 1.0f, layer, color);
+}
+
+void SpriteBatch::end() {
+    PROFILE_ZONE("SpriteBatch::end");
+    drawCallCount = 0;
+    spriteCount = static_cast<int>(entries.size());
+    if (entries.empty() || !vao) return;
+
+    // So thêm sequence để giữ thứ tự gửi vào của các sprite cùng lớp và texture;
+    // std::sort không xin bộ nhớ tạm mỗi frame như stable_sort
+    std::sort(entries.begin(), entries.end(),
+        [](const SpriteEntry& a, const SpriteEntry& b) {
+            return a.key != b.key ? a.key < b.key : a.sequence < b.sequence;
+        });
+
+    uploadBuffer.resize(entries.size());
+    for (size_t i = 0; i < entries.size(); ++i) {
+        uploadBuffer[i] = entries[i].instance;
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    size_t bytes = uploadBuffer.size() * sizeof(SpriteInstance);
+    if (uploadBuffer.size() > instanceCapacity) {
+        instanceCapacity = std::max(uploadBuffer.size(), instanceCapacity * 2);
+    }
+    // Orphan buffer cũ để driver không phải chờ frame trước vẽ xong
+    glBufferData(GL_ARRAY_BUFFER, instanceCapacity * sizeof(SpriteInstance), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, uploadBuffer.data());
+
+    glUseProgram(shaderProgram);
+    glUniform2f(screenSizeLocation, screenWidth, screenHeight);
+    glUniform1i(textureLocation, 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindVertexArray(vao);
+
+    size_t first = 0;
+    while (first < entries.size()) {
+        size_t last = first + 1;
+        while (last < entries.size() && entries[last].key == entries[first].key) ++last;
+
+        glBindTexture(GL_TEXTURE_2D, static_cast<GLuint>(entries[first].key & 0xFFFFFFFFu));
+        setInstanceAttributes(first);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(last - first));
+        ++drawCallCount;
+        first = last;
+    }
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glUseProgram(0);
+}
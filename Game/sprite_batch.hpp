@@ -0,0 +1,73 @@
+﻿#ifndef SPRITE_BATCH_HPP
+#define SPRITE_BATCH_HPP
+
+#include <GL/glew.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "components.hpp"
+
+// Thứ tự lớp vẽ, lớp lớn hơn nằm trên
+enum SpriteLayer {
+    LAYER_BUFFS = 0,
+    LAYER_CHARACTERS = 1,
+    LAYER_PROJECTILES = 2
+};
+
+// Gom tất cả sprite của thế giới trong một frame, sắp xếp theo lớp và texture,
+// rồi vẽ bằng instanced quad từ một VBO duy nhất.
+class SpriteBatch {
+public:
+    SpriteBatch();
+    ~SpriteBatch();
+
+    // shaderProgram phải được tạo từ spriteVertexShaderSource/spriteFragmentShaderSource
+    bool init(GLuint shaderProgram);
+    void shutdown();
+
+    void begin(float screenWidth, float screenHeight);
+    // Toạ độ tính theo pixel màn hình, uv0 ứng với góc trên trái
+    void draw(GLuint textureID, float x0, float y0, float x1, float y1,
+        float u0, float v0, float u1, float v1, int layer, Color tint = Color{ 1.0f, 1.0f, 1.0f, 1.0f });
+    void drawRect(float x0, float y0, float x1, float y1, Color color, int layer);
+    // Sắp xếp và gửi toàn bộ sprite đã thu thập lên GPU
+    void end();
+
+    int getDrawCallCount() const { return drawCallCount; }
+    int getSpriteCount() const { return spriteCount; }
+
+    static const char* vertexShaderSource;
+    static const char* fragmentShaderSource;
+
+private:
+    struct SpriteInstance {
+        float rect[4];
+        float uv[4];
+        uint8_t color[4];
+    };
+
+    struct SpriteEntry {
+        uint64_t key; // (layer << 32) | texture
+        uint32_t sequence; // Thứ tự gọi draw trong frame, giữ ổn định khi sắp xếp
+        SpriteInstance instance;
+    };
+
+    void setInstanceAttributes(size_t firstInstance);
+
+    GLuint shaderProgram;
+    GLuint vao;
+    GLuint quadVBO;
+    GLuint instanceVBO;
+    GLuint whiteTexture;
+    GLint screenSizeLocation;
+    GLint textureLocation;
+    size_t instanceCapacity;
+    float screenWidth, screenHeight;
+
+    std::vector<SpriteEntry> entries;
+    std::vector<SpriteInstance> uploadBuffer;
+    int drawCallCount;
+    int spriteCount;
+};
+
+#endif // SPRITE_BATCH_HPP
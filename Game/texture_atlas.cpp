@@ -0,0 +1,140 @@
+﻿#include "texture_atlas.hpp"
+#include "logger.hpp"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+AtlasPacker::AtlasPacker(int pageWidth, int pageHeight, int padding)
+    : pageWidth(pageWidth), pageHeight(pageHeight), padding(padding) {
+}
+
+bool AtlasPacker::pack(int width, int height, AtlasRect& out) {
+    int paddedWidth = width + padding;
+    int paddedHeight = height + padding;
+    if (paddedWidth > pageWidth || paddedHeight > pageHeight) return false;
+
+    for (size_t page = 0; page <= pages.size(); ++page) {
+        if (page == pages.size()) {
+            pages.push_back({ SkylineNode{ 0, 0, pageWidth } });
+        }
+        int x, y;
+        if (packIntoPage(pages[page], paddedWidth, paddedHeight, x, y)) {
+            out = { x, y, width, height, static_cast<int>(page) };
+            return true;
+        }
+    }
+    return false;
+}
+
+bool AtlasPacker::packIntoPage(std::vector<SkylineNode>& skyline, int width, int height, int& outX, int& outY) {
+    int bestIndex = -1;
+    int bestY = INT_MAX;
+    int bestWaste = INT_MAX;
+
+    // Tìm vị trí thấp nhất đặt vừa hình, hoà thì chọn chỗ để trống ít nhất
+    for (size_t i = 0; i < skyline.size(); ++i) {
+        int x = skyline[i].x;
+        if (x + width > pageWidth) break;
+
+        int y = 0;
+        int remaining = width;
+        int waste = 0;
+        for (size_t j = i; remaining > 0; ++j) {
+            y = std::max(y, skyline[j].y);
+            remaining -= skyline[j].width;
+        }
+        if (y + height > pageHeight) continue;
+        remaining = width;
+        for (size_t j = i; remaining > 0; ++j) {
+            int span = std::min(remaining, skyline[j].width);
+            waste += (y - skyline[j].y) * span;
+            remaining -= span;
+        }
+        if (y < bestY || (y == bestY && waste < bestWaste)) {
+            bestIndex = static_cast<int>(i);
+            bestY = y;
+            bestWaste = waste;
+        }
+    }
+    if (bestIndex < 0) return false;
+
+    outX = skyline[bestIndex].x;
+    outY = bestY;
+
+    // Chèn đoạn mới rồi cắt bớt các đoạn bị nó che phủ
+    skyline.insert(skyline.begin() + bestIndex, SkylineNode{ outX, bestY + height, width });
+    for (size_t i = bestIndex + 1; i < skyline.size(); ) {
+        const SkylineNode& prev = skyline[i - 1];
+        int prevEnd = prev.x + prev.width;
+        if (skyline[i].x >= prevEnd) break;
+        int shrink = prevEnd - skyline[i].x;
+        skyline[i].x += shrink;
+        skyline[i].width -= shrink;
+        if (skyline[i].width <= 0) {
+            skyline.erase(skyline.begin() + i);
+        }
+        else {
+            break;
+        }
+    }
+    for (size_t i = 0; i + 1 < skyline.size(); ) {
+        if (skyline[i].y == skyline[i + 1].y) {
+            skyline[i].width += skyline[i + 1].width;
+            skyline.erase(skyline.begin() + i + 1);
+        }
+        else {
+            ++i;
+        }
+    }
+    return true;
+}
+
+std::vector<AtlasPage> buildAtlasPages(std::vector<AtlasImage>& images, int pageSize) {
+    std::vector<AtlasPage> result;
+
+    // Xếp ảnh cao trước để skyline ít bị lởm chởm
+    std::sort(images.begin(), images.end(),
+        [](const AtlasImage& a, const AtlasImage& b) { return a.height > b.height; });
+
+    AtlasPacker packer(pageSize, pageSize);
+    std::vector<std::pair<const AtlasImage*, AtlasRect>> packed;
+    for (const AtlasImage& image : images) {
+        AtlasRect rect;
+        if (packer.pack(image.width, image.height, rect)) {
+            packed.emplace_back(&image, rect);
+        }
+        else {
+            AtlasPage single;
+            single.width = image.width;
+            single.height = image.height;
+            single.pixels.assign(image.pixels, image.pixels + static_cast<size_t>(image.width) * image.height * 4);
+            single.regions.push_back({ image.key, 0.0f, 0.0f, 1.0f, 1.0f, image.width, image.height });
+            result.push_back(std::move(single));
+        }
+    }
+
+    // Hàng 0 của ảnh được chép vào hàng rect.y của trang, nên ảnh đã lật dọc khi giải mã vẫn đúng chiều
+    for (int pageIndex = 0; pageIndex < packer.pageCount(); ++pageIndex) {
+        AtlasPage page;
+        page.width = pageSize;
+        page.height = pageSize;
+        page.pixels.assign(static_cast<size_t>(pageSize) * pageSize * 4, 0);
+        for (const auto& entry : packed) {
+            const AtlasImage& image = *entry.first;
+            const AtlasRect& rect = entry.second;
+            if (rect.page != pageIndex) continue;
+            for (int row = 0; row < image.height; ++row) {
+                std::memcpy(&page.pixels[(static_cast<size_t>(rect.y + row) * pageSize + rect.x) * 4],
+                    &image.pixels[static_cast<size_t>(row) * image.width * 4],
+                    static_cast<size_t>(image.width) * 4);
+            }
+            page.regions.push_back({ image.key,
+                static_cast<float>(rect.x) / pageSize, static_cast<float>(rect.y) / pageSize,
+                static_cast<float>(rect.x + image.width) / pageSize, static_cast<float>(rect.y + image.height) / pageSize,
+                image.width, image.height });
+        }
+        result.push_back(std::move(page));
+    }
+    LOG_INFO("Packed {} textures into {} atlas page(s)", packed.size(), packer.pageCount());
+    return result;
+}
@@ -0,0 +1,63 @@
+﻿#ifndef TEXTURE_ATLAS_HPP
+#define TEXTURE_ATLAS_HPP
+
+#include <string>
+#include <vector>
+
+struct AtlasRect {
+    int x, y;
+    int width, height;
+    int page;
+};
+
+// Ảnh RGBA đã giải mã, đầu vào cho buildAtlasPages
+struct AtlasImage {
+    std::string key;
+    int width, height;
+    const unsigned char* pixels;
+};
+
+// Vị trí của một ảnh trong trang atlas, tính theo UV
+struct AtlasRegion {
+    std::string key;
+    float u0, v0, u1, v1;
+    int width, height;
+};
+
+// Một texture RGBA hoàn chỉnh cùng các ảnh nằm trong nó
+struct AtlasPage {
+    int width = 0, height = 0;
+    std::vector<unsigned char> pixels;
+    std::vector<AtlasRegion> regions;
+};
+
+// Xếp hình chữ nhật vào các trang atlas theo thuật toán skyline bottom-left.
+// Chỉ tính toán vị trí, không đụng tới OpenGL nên dùng được cả khi đóng gói offline.
+class AtlasPacker {
+public:
+    AtlasPacker(int pageWidth, int pageHeight, int padding = 2);
+
+    // Trả về false nếu hình lớn hơn một trang
+    bool pack(int width, int height, AtlasRect& out);
+    int pageCount() const { return static_cast<int>(pages.size()); }
+    int getPageWidth() const { return pageWidth; }
+    int getPageHeight() const { return pageHeight; }
+
+private:
+    struct SkylineNode {
+        int x, y, width;
+    };
+
+    bool packIntoPage(std::vector<SkylineNode>& skyline, int width, int height, int& outX, int& outY);
+
+    int pageWidth;
+    int pageHeight;
+    int padding;
+    std::vector<std::vector<SkylineNode>> pages;
+};
+
+// Xếp các ảnh vào trang atlas pageSize x pageSize (images sẽ bị sắp xếp lại).
+// Ảnh lớn hơn một trang được trả về thành trang riêng.
+std::vector<AtlasPage> buildAtlasPages(std::vector<AtlasImage>& images, int pageSize);
+
+#endif // TEXTURE_ATLAS_HPP
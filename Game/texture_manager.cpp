@@ -1,34 +1,32 @@
 ﻿#include "texture_manager.hpp"
+#include "asset_pack.hpp"
+#include "thread_pool.hpp"
+#include "logger.hpp"
 #include "stb_image.h"
-#include <iostream>
+#include <algorithm>
 
-TextureManager::TextureManager() {}
+const unsigned LOADER_THREADS = 2;
+
+TextureManager::TextureManager() : textureBytes(0), placeholderTexture(0), generation(0), decodingCount(0) {}
 
 TextureManager::~TextureManager() {
+    // Chờ các task giải mã xong trước khi giải phóng hàng đợi mà chúng ghi vào
+    loaderPool.reset();
     clear();
 }
 
-GLuint TextureManager::loadTexture(const std::string& key, const std::string& filepath) {
-    // Kiểm tra nếu texture đã được tải
-    auto it = textures.find(key);
-    if (it != textures.end()) {
-        return it->second;
-    }
-
-    std::cout << "Loading texture: " << filepath << "\n";
-    int width, height, channels;
-    stbi_set_flip_vertically_on_load(true);
-    unsigned char* image = stbi_load(filepath.c_str(), &width, &height, &channels, 4);
-    if (!image) {
-        std::cerr << "Failed to load texture: " << filepath << "\n";
-        std::cerr << "Reason: " << stbi_failure_reason() << "\n";
-        return 0;
+ThreadPool& TextureManager::getLoaderPool() {
+    if (!loaderPool) {
+        loaderPool = std::make_unique<ThreadPool>(LOADER_THREADS);
     }
+    return *loaderPool;
+}
 
+GLuint TextureManager::createTexture(int width, int height, const unsigned char* pixels) {
     GLuint textureID;
     glGenTextures(1, &textureID);
     glBindTexture(GL_TEXTURE_2D, textureID);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -36,25 +34,286 @@ GLuint TextureManager::loadTexture(const std::string& key, const std::string& fi
 
     GLenum err = glGetError();
     if (err != GL_NO_ERROR) {
-        std::cerr << "OpenGL error after loading texture: " << err << "\n";
+        LOG_ERROR("OpenGL error after loading texture: {}", err);
     }
-
-    stbi_image_free(image);
-    textures[key] = textureID;
+    ownedTextures.push_back(textureID);
+    textureBytes += static_cast<size_t>(width) * height * 4;
     return textureID;
 }
 
-GLuint TextureManager::getTexture(const std::string& key) const {
-    auto it = textures.find(key);
-    if (it != textures.end()) {
+GLuint TextureManager::getPlaceholder() {
+    if (placeholderTexture == 0) {
+        const unsigned char transparent[4] = { 0, 0, 0, 0 };
+        placeholderTexture = createTexture(1, 1, transparent);
+    }
+    return placeholderTexture;
+}
+
+bool TextureManager::decodeImage(const std::string& key, const std::string& filepath, DecodedImage& out) {
+    LOG_INFO("Loading texture: {}", filepath);
+    int width, height, channels;
+    // Dùng cờ lật theo từng thread vì hàm này chạy trên cả thread nền
+    stbi_set_flip_vertically_on_load_thread(true);
+    unsigned char* image = stbi_load(filepath.c_str(), &width, &height, &channels, 4);
+    if (!image) {
+        LOG_ERROR("Failed to load texture: {} ({})", filepath, stbi_failure_reason());
+        return false;
+    }
+    out.key = key;
+    out.width = width;
+    out.height = height;
+    out.pixels = image;
+    return true;
+}
+
+GLuint TextureManager::loadTexture(const std::string& key, const std::string& filepath) {
+    // Kiểm tra nếu texture đã được tải
+    if (isRequested(key)) {
+        return getTexture(key);
+    }
+
+    DecodedImage image;
+    if (!decodeImage(key, filepath, image)) {
+        return 0;
+    }
+
+    TextureRegion region;
+    region.textureID = createTexture(image.width, image.height, image.pixels);
+    region.width = image.width;
+    region.height = image.height;
+    stbi_image_free(image.pixels);
+    setRegion(getTextureId(key), region);
+    return region.textureID;
+}
+
+std::vector<AtlasPage> TextureManager::packImages(std::vector<DecodedImage>& images, int pageSize) {
+    std::vector<AtlasImage> atlasImages;
+    for (const DecodedImage& image : images) {
+        atlasImages.push_back({ image.key, image.width, image.height, image.pixels });
+    }
+    std::vector<AtlasPage> pages = buildAtlasPages(atlasImages, pageSize);
+    for (DecodedImage& image : images) {
+        stbi_image_free(image.pixels);
+        image.pixels = nullptr;
+    }
+    return pages;
+}
+
+void TextureManager::registerRegions(GLuint textureID, const std::vector<AtlasRegion>& atlasRegions) {
+    for (const AtlasRegion& atlasRegion : atlasRegions) {
+        TextureRegion region;
+        region.textureID = textureID;
+        region.u0 = atlasRegion.u0;
+        region.v0 = atlasRegion.v0;
+        region.u1 = atlasRegion.u1;
+        region.v1 = atlasRegion.v1;
+        region.width = atlasRegion.width;
+        region.height = atlasRegion.height;
+        setRegion(getTextureId(atlasRegion.key), region);
+    }
+}
+
+void TextureManager::loadAtlas(const std::vector<std::pair<std::string, std::string>>& entries, int pageSize) {
+    std::vector<DecodedImage> images;
+    for (const auto& entry : entries) {
+        if (isRequested(entry.first)) continue;
+        DecodedImage image;
+        if (decodeImage(entry.first, entry.second, image)) {
+            images.push_back(image);
+        }
+    }
+    for (AtlasPage& page : packImages(images, pageSize)) {
+        registerRegions(createTexture(page.width, page.height, page.pixels.data()), page.regions);
+    }
+}
+
+void TextureManager::queueUpload(AtlasPage&& page) {
+    std::lock_guard<std::mutex> lock(uploadMutex);
+    pendingUploads.push_back(std::move(page));
+}
+
+void TextureManager::queueFailure(const std::string& key) {
+    std::lock_guard<std::mutex> lock(uploadMutex);
+    failedKeys.push_back(key);
+}
+
+GLuint TextureManager::loadTextureAsync(const std::string& key, const std::string& filepath) {
+    if (isRequested(key)) {
+        return getTexture(key);
+    }
+
+    TextureRegion placeholder;
+    placeholder.textureID = getPlaceholder();
+    setRegion(getTextureId(key), placeholder);
+
+    decodingCount.fetch_add(1);
+    getLoaderPool().submit([this, key, filepath] {
+        DecodedImage image;
+        if (decodeImage(key, filepath, image)) {
+            AtlasPage decoded;
+            decoded.width = image.width;
+            decoded.height = image.height;
+            decoded.pixels.assign(image.pixels, image.pixels + static_cast<size_t>(image.width) * image.height * 4);
+            stbi_image_free(image.pixels);
+            decoded.regions.push_back({ key, 0.0f, 0.0f, 1.0f, 1.0f, image.width, image.height });
+            queueUpload(std::move(decoded));
+        }
+        else {
+            queueFailure(key);
+        }
+        decodingCount.fetch_sub(1);
+    });
+    return placeholder.textureID;
+}
+
+void TextureManager::loadAtlasAsync(const std::vector<std::pair<std::string, std::string>>& entries, int pageSize) {
+    // Mỗi ảnh được giải mã trong một task riêng; task xong cuối cùng sẽ xếp atlas
+    struct AtlasJob {
+        std::vector<DecodedImage> images;
+        std::vector<char> decoded;
+        std::atomic<int> remaining{ 0 };
+        int pageSize = 0;
+    };
+    auto job = std::make_shared<AtlasJob>();
+    job->pageSize = pageSize;
+
+    std::vector<std::pair<std::string, std::string>> toLoad;
+    TextureRegion placeholder;
+    placeholder.textureID = getPlaceholder();
+    for (const auto& entry : entries) {
+        if (isRequested(entry.first)) continue;
+        setRegion(getTextureId(entry.first), placeholder);
+        toLoad.push_back(entry);
+    }
+    if (toLoad.empty()) return;
+
+    job->images.resize(toLoad.size());
+    job->decoded.resize(toLoad.size(), 0);
+    job->remaining = static_cast<int>(toLoad.size());
+    decodingCount.fetch_add(1);
+
+    for (size_t i = 0; i < toLoad.size(); ++i) {
+        std::string key = toLoad[i].first;
+        std::string filepath = toLoad[i].second;
+        getLoaderPool().submit([this, job, i, key, filepath] {
+            if (decodeImage(key, filepath, job->images[i])) {
+                job->decoded[i] = 1;
+            }
+            else {
+                queueFailure(key);
+            }
+            if (job->remaining.fetch_sub(1) != 1) return;
+
+            std::vector<DecodedImage> images;
+            for (size_t j = 0; j < job->images.size(); ++j) {
+                if (job->decoded[j]) images.push_back(job->images[j]);
+            }
+            for (AtlasPage& page : packImages(images, job->pageSize)) {
+                queueUpload(std::move(page));
+            }
+            decodingCount.fetch_sub(1);
+        });
+    }
+}
+
+bool TextureManager::loadAssetPack(const std::string& filepath) {
+    AssetPack pack;
+    if (!pack.open(filepath)) {
+        return false;
+    }
+    LOG_INFO("Loading asset pack: {}", filepath);
+
+    // Dữ liệu đã là RGBA lật sẵn: đưa thẳng con trỏ vào vùng map cho glTexImage2D
+    std::vector<GLuint> textureIDs(pack.textureCount());
+    for (uint32_t i = 0; i < pack.textureCount(); ++i) {
+        const AssetPackTexture& entry = pack.texture(i);
+        textureIDs[i] = createTexture(static_cast<int>(entry.width), static_cast<int>(entry.height), pack.pixels(i));
+    }
+    for (uint32_t i = 0; i < pack.regionCount(); ++i) {
+        const AssetPackRegion& entry = pack.region(i);
+        TextureRegion region;
+        region.textureID = textureIDs[entry.texture];
+        region.u0 = entry.u0;
+        region.v0 = entry.v0;
+        region.u1 = entry.u1;
+        region.v1 = entry.v1;
+        region.width = static_cast<int>(entry.width);
+        region.height = static_cast<int>(entry.height);
+        setRegion(getTextureId(entry.key), region);
+    }
+    return true;
+}
+
+void TextureManager::processUploads(Arena& frameArena, int maxUploads) {
+    std::vector<AtlasPage, ArenaAllocator<AtlasPage>> ready{ ArenaAllocator<AtlasPage>(frameArena) };
+    ready.reserve(maxUploads);
+    std::vector<std::string> failed;
+    {
+        std::lock_guard<std::mutex> lock(uploadMutex);
+        while (!pendingUploads.empty() && static_cast<int>(ready.size()) < maxUploads) {
+            ready.push_back(std::move(pendingUploads.front()));
+            pendingUploads.pop_front();
+        }
+        failed.swap(failedKeys);
+    }
+    for (AtlasPage& page : ready) {
+        registerRegions(createTexture(page.width, page.height, page.pixels.data()), page.regions);
+    }
+    // Ảnh lỗi trả về 0 giống loadTexture để nơi gọi dùng hình thay thế
+    for (const std::string& key : failed) {
+        setRegion(getTextureId(key), TextureRegion());
+    }
+}
+
+bool TextureManager::isLoading() const {
+    std::lock_guard<std::mutex> lock(uploadMutex);
+    return decodingCount.load() > 0 || !pendingUploads.empty();
+}
+
+TextureId TextureManager::getTextureId(const std::string& key) {
+    auto it = textureIds.find(key);
+    if (it != textureIds.end()) {
         return it->second;
     }
+    TextureId id = static_cast<TextureId>(regions.size());
+    textureIds.emplace(key, id);
+    regions.emplace_back();
+    textureNames.push_back(key);
+    return id;
+}
+
+void TextureManager::setRegion(TextureId id, const TextureRegion& region) {
+    regions[id] = region;
+    ++generation;
+}
+
+bool TextureManager::isRequested(const std::string& key) const {
+    return getTexture(key) != 0;
+}
+
+GLuint TextureManager::getTexture(const std::string& key) const {
+    auto it = textureIds.find(key);
+    if (it != textureIds.end()) {
+        return regions[it->second].textureID;
+    }
     return 0;
 }
 
+TextureRegion TextureManager::getRegion(const std::string& key) const {
+    auto it = textureIds.find(key);
+    if (it != textureIds.end()) {
+        return regions[it->second];
+    }
+    return TextureRegion();
+}
+
 void TextureManager::clear() {
-    for (auto& pair : textures) {
-        glDeleteTextures(1, &pair.second);
+    for (GLuint textureID : ownedTextures) {
+        glDeleteTextures(1, &textureID);
     }
-    textures.clear();
+    ownedTextures.clear();
+    textureBytes = 0;
+    std::fill(regions.begin(), regions.end(), TextureRegion());
+    ++generation;
+    placeholderTexture = 0;
 }
@@ -2,8 +2,29 @@
 #define TEXTURE_MANAGER_HPP
 
 #include <GL/glew.h>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <map>
+#include <utility>
+#include <vector>
+#include "arena.hpp"
+#include "texture_atlas.hpp"
+
+class ThreadPool;
+
+// Handle của một key texture, cấp một lần khi đăng ký tên rồi dùng thay cho chuỗi ở mỗi frame
+typedef uint32_t TextureId;
+
+// Vùng của một ảnh bên trong texture (toàn bộ texture nếu ảnh được tải riêng)
+struct TextureRegion {
+    GLuint textureID = 0;
+    float u0 = 0.0f, v0 = 0.0f, u1 = 1.0f, v1 = 1.0f;
+    int width = 0, height = 0;
+};
 
 class TextureManager {
 public:
@@ -12,13 +33,69 @@ public:
 
     // Tải texture từ file và lưu vào map với key
     GLuint loadTexture(const std::string& key, const std::string& filepath);
-    // Lấy texture ID theo key
+    // Gói nhiều ảnh (key, đường dẫn) vào một hoặc vài trang atlas dùng chung texture
+    void loadAtlas(const std::vector<std::pair<std::string, std::string>>& entries, int pageSize = 2048);
+    // Giống loadTexture nhưng giải mã trên thread nền. Trả về ngay một texture tạm
+    // trong suốt, texture thật được upload trong processUploads().
+    GLuint loadTextureAsync(const std::string& key, const std::string& filepath);
+    // Giống loadAtlas nhưng giải mã và xếp atlas trên thread nền
+    void loadAtlasAsync(const std::vector<std::pair<std::string, std::string>>& entries, int pageSize = 2048);
+    // Tải file asset pack tạo bởi asset_packer: map file vào bộ nhớ và upload thẳng, không giải mã
+    bool loadAssetPack(const std::string& filepath);
+    // Gọi trên thread OpenGL mỗi frame: upload tối đa maxUploads texture đã giải mã xong.
+    // Danh sách tạm lấy từ frameArena nên frame không có gì để upload không cấp phát.
+    void processUploads(Arena& frameArena, int maxUploads = 2);
+    // Còn ảnh đang giải mã hoặc chờ upload
+    bool isLoading() const;
+    // Cấp (hoặc trả lại) handle cho key. Handle hợp lệ cả trước khi ảnh tải xong
+    TextureId getTextureId(const std::string& key);
+    const std::string& getTextureName(TextureId id) const { return textureNames[id]; }
+    // Lấy texture ID theo handle, 0 nếu ảnh chưa được tải hoặc tải lỗi
+    GLuint getTexture(TextureId id) const { return regions[id].textureID; }
     GLuint getTexture(const std::string& key) const;
-    // Xóa tất cả texture
+    // Lấy vùng UV của ảnh theo handle
+    const TextureRegion& getRegion(TextureId id) const { return regions[id]; }
+    TextureRegion getRegion(const std::string& key) const;
+    // Tăng mỗi khi vùng của một key thay đổi (ảnh tải xong, tải lỗi, clear)
+    uint32_t getGeneration() const { return generation; }
+    // Số texture OpenGL đang giữ và dung lượng ước tính của chúng (RGBA8, không tính mipmap)
+    size_t getTextureCount() const { return ownedTextures.size(); }
+    size_t getTextureBytes() const { return textureBytes; }
+    // Xóa tất cả texture. Các handle đã cấp vẫn giữ nguyên và trỏ tới vùng rỗng
     void clear();
 
 private:
-    std::map<std::string, GLuint> textures;
+    struct DecodedImage {
+        std::string key;
+        int width = 0, height = 0;
+        unsigned char* pixels = nullptr;
+    };
+
+    static bool decodeImage(const std::string& key, const std::string& filepath, DecodedImage& out);
+    static std::vector<AtlasPage> packImages(std::vector<DecodedImage>& images, int pageSize);
+    GLuint createTexture(int width, int height, const unsigned char* pixels);
+    void registerRegions(GLuint textureID, const std::vector<AtlasRegion>& atlasRegions);
+    // Key đã có texture (thật hoặc tạm đang chờ tải)
+    bool isRequested(const std::string& key) const;
+    void setRegion(TextureId id, const TextureRegion& region);
+    GLuint getPlaceholder();
+    void queueUpload(AtlasPage&& page);
+    void queueFailure(const std::string& key);
+    ThreadPool& getLoaderPool();
+
+    std::map<std::string, TextureId> textureIds; // Chỉ dùng khi tải và tra cứu theo tên
+    std::vector<TextureRegion> regions;          // Đánh số theo TextureId
+    std::vector<std::string> textureNames;
+    std::vector<GLuint> ownedTextures;
+    size_t textureBytes;
+    GLuint placeholderTexture;
+    uint32_t generation;
+
+    std::unique_ptr<ThreadPool> loaderPool;
+    mutable std::mutex uploadMutex;
+    std::deque<AtlasPage> pendingUploads;
+    std::vector<std::string> failedKeys;
+    std::atomic<int> decodingCount;
 };
 
 #endif // TEXTURE_MANAGER_HPP
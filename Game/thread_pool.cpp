@@ -0,0 +1,92 @@
+﻿#include "thread_pool.hpp"
+
+ThreadPool::ThreadPool(unsigned threadCount)
+    : pending(0), nextQueue(0), stopping(false) {
+    if (threadCount == 0) threadCount = std::thread::hardware_concurrency();
+    if (threadCount == 0) threadCount = 1;
+    for (unsigned i = 0; i < threadCount; ++i) {
+        queues.push_back(std::make_unique<WorkerQueue>());
+    }
+    for (unsigned i = 0; i < threadCount; ++i) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        stopping = true;
+    }
+    wakeCondition.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    unsigned index = nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+    pending.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(queues[index]->mutex);
+        queues[index]->tasks.push_back(std::move(task));
+    }
+    {
+        // Khóa để worker đang chuẩn bị ngủ không bỏ lỡ thông báo
+        std::lock_guard<std::mutex> lock(stateMutex);
+    }
+    wakeCondition.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(stateMutex);
+    doneCondition.wait(lock, [this] { return pending.load() == 0; });
+}
+
+bool ThreadPool::popTask(unsigned index, std::function<void()>& task) {
+    {
+        WorkerQueue& own = *queues[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.front());
+            own.tasks.pop_front();
+            return true;
+        }
+    }
+    for (size_t offset = 1; offset < queues.size(); ++offset) {
+        WorkerQueue& victim = *queues[(index + offset) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.back());
+            victim.tasks.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(unsigned index) {
+    std::function<void()> task;
+    while (true) {
+        if (popTask(index, task)) {
+            task();
+            task = nullptr;
+            if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                std::lock_guard<std::mutex> lock(stateMutex);
+                doneCondition.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(stateMutex);
+        if (stopping) return;
+        wakeCondition.wait(lock, [this] {
+            if (stopping) return true;
+            for (auto& queue : queues) {
+                std::lock_guard<std::mutex> queueLock(queue->mutex);
+                if (!queue->tasks.empty()) return true;
+            }
+            return false;
+        });
+        if (stopping && pending.load() == 0) return;
+    }
+}
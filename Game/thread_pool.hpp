@@ -0,0 +1,47 @@
+﻿#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Thread pool kiểu work-stealing: mỗi worker có hàng đợi riêng,
+// hết việc thì lấy trộm từ cuối hàng đợi của worker khác.
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned threadCount = 0);
+    ~ThreadPool();
+
+    void submit(std::function<void()> task);
+    // Chờ đến khi mọi task đã submit chạy xong
+    void wait();
+    unsigned size() const { return static_cast<unsigned>(workers.size()); }
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    bool popTask(unsigned index, std::function<void()>& task);
+    void workerLoop(unsigned index);
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<size_t> pending;
+    std::atomic<unsigned> nextQueue;
+    bool stopping;
+    std::mutex stateMutex;
+    std::condition_variable wakeCondition;
+    std::condition_variable doneCondition;
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+};
+
+#endif // THREAD_POOL_HPP
@@ -0,0 +1,217 @@
+﻿#include "udp_socket.hpp"
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <mutex>
+#pragma comment(lib, "ws2_32.lib")
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+#ifdef _WIN32
+static bool initSockets() {
+    static std::once_flag once;
+    static bool ready = false;
+    std::call_once(once, [] {
+        WSADATA data;
+        ready = WSAStartup(MAKEWORD(2, 2), &data) == 0;
+    });
+    return ready;
+}
+#endif
+
+bool parseAddress(const std::string& text, NetAddress& address) {
+    unsigned a, b, c, d, port;
+    char tail;
+    if (std::sscanf(text.c_str(), "%u.%u.%u.%u:%u%c", &a, &b, &c, &d, &port, &tail) != 5) return false;
+    if (a > 255 || b > 255 || c > 255 || d > 255 || port == 0 || port > 65535) return false;
+    address.ip = (a << 24) | (b << 16) | (c << 8) | d;
+    address.port = static_cast<uint16_t>(port);
+    return true;
+}
+
+std::string formatAddress(const NetAddress& address) {
+    char text[24];
+    std::snprintf(text, sizeof(text), "%u.%u.%u.%u:%u", address.ip >> 24, (address.ip >> 16) & 0xFF,
+        (address.ip >> 8) & 0xFF, address.ip & 0xFF, address.port);
+    return text;
+}
+
+bool UdpSocket::open(uint16_t port) {
+    close();
+#ifdef _WIN32
+    if (!initSockets()) return false;
+    SOCKET s = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (s == INVALID_SOCKET) return false;
+    u_long nonBlocking = 1;
+    bool ok = ioctlsocket(s, FIONBIO, &nonBlocking) == 0;
+#else
+    int s = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (s < 0) return false;
+    bool ok = fcntl(s, F_SETFL, fcntl(s, F_GETFL, 0) | O_NONBLOCK) == 0;
+#endif
+    handle = static_cast<intptr_t>(s);
+    // Server nhận gói của hàng trăm client trên một socket: bộ đệm mặc định đầy sau vài chục gói
+    int bufferSize = 4 * 1024 * 1024;
+    setsockopt(s, SOL_SOCKET, SO_RCVBUF, reinterpret_cast<const char*>(&bufferSize), sizeof(bufferSize));
+    setsockopt(s, SOL_SOCKET, SO_SNDBUF, reinterpret_cast<const char*>(&bufferSize), sizeof(bufferSize));
+
+    sockaddr_in local = {};
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    local.sin_port = htons(port);
+    if (!ok || ::bind(s, reinterpret_cast<const sockaddr*>(&local), sizeof(local)) != 0) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void UdpSocket::close() {
+    if (handle == INVALID_HANDLE) return;
+#ifdef _WIN32
+    closesocket(static_cast<SOCKET>(handle));
+#else
+    ::close(static_cast<int>(handle));
+#endif
+    handle = INVALID_HANDLE;
+}
+
+uint16_t UdpSocket::localPort() const {
+    sockaddr_in local = {};
+#ifdef _WIN32
+    int length = sizeof(local);
+    if (getsockname(static_cast<SOCKET>(handle), reinterpret_cast<sockaddr*>(&local), &length) != 0) return 0;
+#else
+    socklen_t length = sizeof(local);
+    if (getsockname(static_cast<int>(handle), reinterpret_cast<sockaddr*>(&local), &length) != 0) return 0;
+#endif
+    return ntohs(local.sin_port);
+}
+
+bool UdpSocket::send(const NetAddress& to, const uint8_t* data, size_t size) {
+    sockaddr_in remote = {};
+    remote.sin_family = AF_INET;
+    remote.sin_addr.s_addr = htonl(to.ip);
+    remote.sin_port = htons(to.port);
+#ifdef _WIN32
+    int sent = ::sendto(static_cast<SOCKET>(handle), reinterpret_cast<const char*>(data), static_cast<int>(size), 0,
+        reinterpret_cast<const sockaddr*>(&remote), sizeof(remote));
+#else
+    ssize_t sent = ::sendto(static_cast<int>(handle), data, size, 0,
+        reinterpret_cast<const sockaddr*>(&remote), sizeof(remote));
+#endif
+    return sent == static_cast<decltype(sent)>(size);
+}
+
+size_t UdpSocket::receive(NetAddress& from, uint8_t* out, size_t capacity) {
+    sockaddr_in remote = {};
+    for (;;) {
+#ifdef _WIN32
+        int length = sizeof(remote);
+        int received = ::recvfrom(static_cast<SOCKET>(handle), reinterpret_cast<char*>(out), static_cast<int>(capacity), 0,
+            reinterpret_cast<sockaddr*>(&remote), &length);
+        // Gói quá dài (WSAEMSGSIZE) hoặc ICMP port unreachable (WSAECONNRESET) thì đọc gói kế tiếp
+        if (received < 0 && (WSAGetLastError() == WSAEMSGSIZE || WSAGetLastError() == WSAECONNRESET)) continue;
+        bool truncated = false;
+#else
+        socklen_t length = sizeof(remote);
+        msghdr message = {};
+        iovec buffer = { out, capacity };
+        message.msg_name = &remote;
+        message.msg_namelen = length;
+        message.msg_iov = &buffer;
+        message.msg_iovlen = 1;
+        ssize_t received = ::recvmsg(static_cast<int>(handle), &message, 0);
+        if (received < 0 && errno == EINTR) continue;
+        bool truncated = (message.msg_flags & MSG_TRUNC) != 0;
+#endif
+        if (received <= 0) return 0; // Không còn gói (EWOULDBLOCK) hoặc lỗi
+        if (truncated) continue;
+        from.ip = ntohl(remote.sin_addr.s_addr);
+        from.port = ntohs(remote.sin_port);
+        return static_cast<size_t>(received);
+    }
+}
+
+#ifdef _WIN32
+
+NetPoller::NetPoller() {
+}
+
+NetPoller::~NetPoller() {
+}
+
+bool NetPoller::add(const UdpSocket& socket, uint32_t tag) {
+    if (!socket.isOpen()) return false;
+    entries.push_back(Entry{ socket.nativeHandle(), tag });
+    pollFds.resize(entries.size() * sizeof(WSAPOLLFD));
+    return true;
+}
+
+int NetPoller::wait(int timeoutMs, std::vector<uint32_t>& readyTags) {
+    readyTags.clear();
+    if (entries.empty()) {
+        if (timeoutMs > 0) Sleep(timeoutMs);
+        return 0;
+    }
+    WSAPOLLFD* fds = reinterpret_cast<WSAPOLLFD*>(pollFds.data());
+    for (size_t i = 0; i < entries.size(); ++i) {
+        fds[i].fd = static_cast<SOCKET>(entries[i].handle);
+        fds[i].events = POLLRDNORM;
+        fds[i].revents = 0;
+    }
+    int ready = WSAPoll(fds, static_cast<ULONG>(entries.size()), timeoutMs);
+    for (size_t i = 0; ready > 0 && i < entries.size(); ++i) {
+        if (fds[i].revents != 0) readyTags.push_back(entries[i].tag);
+    }
+    return static_cast<int>(readyTags.size());
+}
+
+#else
+
+NetPoller::NetPoller() {
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+}
+
+NetPoller::~NetPoller() {
+    if (epollFd >= 0) ::close(epollFd);
+}
+
+bool NetPoller::add(const UdpSocket& socket, uint32_t tag) {
+    if (epollFd < 0 || !socket.isOpen()) return false;
+    // Level-triggered: socket còn gói chưa đọc thì lần wait sau báo tiếp, không sợ bỏ sót
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.u32 = tag;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, static_cast<int>(socket.nativeHandle()), &event) != 0) return false;
+    events.resize(events.size() + sizeof(epoll_event));
+    return true;
+}
+
+int NetPoller::wait(int timeoutMs, std::vector<uint32_t>& readyTags) {
+    readyTags.clear();
+    if (epollFd < 0 || events.empty()) {
+        if (timeoutMs > 0) usleep(static_cast<useconds_t>(timeoutMs) * 1000);
+        return 0;
+    }
+    epoll_event* list = reinterpret_cast<epoll_event*>(events.data());
+    int maxEvents = static_cast<int>(events.size() / sizeof(epoll_event));
+    int ready = epoll_wait(epollFd, list, maxEvents, timeoutMs);
+    for (int i = 0; i < ready; ++i) {
+        readyTags.push_back(list[i].data.u32);
+    }
+    return static_cast<int>(readyTags.size());
+}
+
+#endif
@@ -0,0 +1,83 @@
+﻿#ifndef UDP_SOCKET_HPP
+#define UDP_SOCKET_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+const size_t MAX_UDP_PACKET_SIZE = 1400; // Dưới MTU thường gặp để gói không bị phân mảnh
+
+// Địa chỉ IPv4 và cổng, theo thứ tự byte của máy
+struct NetAddress {
+    uint32_t ip = 0;
+    uint16_t port = 0;
+
+    bool operator==(const NetAddress& other) const { return ip == other.ip && port == other.port; }
+    bool operator!=(const NetAddress& other) const { return !(*this == other); }
+};
+
+// "127.0.0.1:7777"; false nếu sai định dạng
+bool parseAddress(const std::string& text, NetAddress& address);
+std::string formatAddress(const NetAddress& address);
+
+// Socket UDP không chặn: send()/receive() trả về ngay, dùng NetPoller để chờ gói đến.
+// Winsock trên Windows, socket BSD trên Linux
+class UdpSocket {
+public:
+    UdpSocket() = default;
+    ~UdpSocket() { close(); }
+
+    // Mở socket trên mọi địa chỉ của máy; port 0 để hệ điều hành chọn cổng trống
+    bool open(uint16_t port);
+    void close();
+    bool isOpen() const { return handle != INVALID_HANDLE; }
+    // Cổng đã mở, hữu ích khi open(0)
+    uint16_t localPort() const;
+
+    // false nếu hệ điều hành không nhận gói (bộ đệm gửi đầy cũng tính là mất gói như UDP)
+    bool send(const NetAddress& to, const uint8_t* data, size_t size);
+    // Số byte của gói kế tiếp, 0 nếu chưa có gói nào. Gói dài hơn capacity bị cắt và bỏ
+    size_t receive(NetAddress& from, uint8_t* out, size_t capacity);
+
+    intptr_t nativeHandle() const { return handle; }
+
+private:
+    static constexpr intptr_t INVALID_HANDLE = -1;
+    intptr_t handle = INVALID_HANDLE;
+
+    UdpSocket(const UdpSocket&) = delete;
+    UdpSocket& operator=(const UdpSocket&) = delete;
+};
+
+// Chờ nhiều socket cùng lúc: epoll trên Linux, WSAPoll trên Windows.
+// Chỉ báo "có gói để đọc"; bên gọi đọc hết bằng receive() cho đến khi nó trả về 0
+class NetPoller {
+public:
+    NetPoller();
+    ~NetPoller();
+
+    // tag được trả lại khi socket có gói; socket phải sống lâu hơn poller
+    bool add(const UdpSocket& socket, uint32_t tag);
+    // Chờ tối đa timeoutMs (0 là không chờ), ghi tag của các socket có gói vào readyTags.
+    // Trả về số socket sẵn sàng
+    int wait(int timeoutMs, std::vector<uint32_t>& readyTags);
+
+private:
+#ifdef _WIN32
+    struct Entry {
+        intptr_t handle;
+        uint32_t tag;
+    };
+    std::vector<Entry> entries;
+    std::vector<uint8_t> pollFds; // Mảng WSAPOLLFD, giữ dạng byte để header không kéo theo winsock2.h
+#else
+    int epollFd = -1;
+    std::vector<uint8_t> events; // Mảng epoll_event cho epoll_wait
+#endif
+
+    NetPoller(const NetPoller&) = delete;
+    NetPoller& operator=(const NetPoller&) = delete;
+};
+
+#endif // UDP_SOCKET_HPP